@@ -0,0 +1,48 @@
+#ifndef ACCESS_POLICY_H
+#define ACCESS_POLICY_H
+
+#include <cassert>   // Required for assert
+#include <cstddef>   // Required for size_t
+#include <stdexcept> // Required for std::out_of_range
+
+// Bounds-checking policies for ObservableContainer element access.
+//
+// A policy provides:
+//   - require(index, size): used by at() and the read-modify-write operations,
+//                           which must reject an out-of-range index.
+//   - accept(index, size):  used by modify(), where an out-of-range index is
+//                           ignored. Returns whether the access may proceed.
+// The container checks the bound once per call through the policy and then
+// uses unchecked element access. modify_unchecked()/at_unchecked() bypass the
+// policy entirely.
+
+// Default policy: out-of-range at() throws, out-of-range modify() is a no-op.
+struct CheckedAccess {
+    static void require(size_t index, size_t size) {
+        if (index >= size) throw std::out_of_range("Index out of range");
+    }
+    static bool accept(size_t index, size_t size) noexcept {
+        return index < size;
+    }
+};
+
+// Bounds are asserted in debug builds and not checked at all with NDEBUG.
+struct DebugAssertAccess {
+    static void require(size_t index, size_t size) noexcept {
+        assert(index < size && "Index out of range");
+        (void)index;
+        (void)size;
+    }
+    static bool accept(size_t index, size_t size) noexcept {
+        require(index, size);
+        return true;
+    }
+};
+
+// No bounds checks: callers guarantee every index is valid.
+struct UncheckedAccess {
+    static void require(size_t, size_t) noexcept {}
+    static bool accept(size_t, size_t) noexcept { return true; }
+};
+
+#endif // ACCESS_POLICY_H
@@ -0,0 +1,534 @@
+#ifndef ASYNC_FILE_WRITER_H
+#define ASYNC_FILE_WRITER_H
+
+#include <algorithm>          // Required for std::min, std::max
+#include <atomic>             // Required for std::atomic
+#include <cerrno>             // Required for errno, EINTR
+#include <condition_variable> // Required for std::condition_variable
+#include <cstdint>            // Required for uint64_t
+#include <functional>         // Required for std::function
+#include <memory>             // Required for std::unique_ptr
+#include <mutex>              // Required for std::mutex, std::unique_lock
+#include <exception>          // Required for std::terminate
+#include <system_error>       // Required for std::system_error
+#include <thread>             // Required for std::thread
+#include <vector>             // Required for std::vector
+#include <unistd.h>           // Required for pwrite, fdatasync
+#include "ThreadPool.h"
+#include "ValueCodec.h"
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <cstring>        // Required for std::memset
+#include <linux/io_uring.h>
+#include <sys/mman.h>     // Required for mmap, munmap
+#include <sys/syscall.h>  // Required for SYS_io_uring_setup, SYS_io_uring_enter
+#define OBSERVABLE_HAVE_IO_URING 1
+#endif
+
+// Asynchronous positional file writes for journals and snapshots.
+//
+// A batch is one contiguous write at `offset`, optionally followed by an
+// fdatasync. The writer owns the buffer until the batch completes and then
+// calls `done` with 0 or a positive errno value. Completions always run on
+// an I/O thread, never inside submit(), so callers may hold the lock their
+// completion takes while submitting. Batches may complete out of submission
+// order; callers that need ordered durability (ChangeJournal) track a
+// watermark themselves. submit() throws std::system_error if the batch cannot
+// be queued; `done` is then never called.
+class AsyncFileWriter {
+public:
+    using Completion = std::function<void(int error)>;
+
+    virtual ~AsyncFileWriter() = default;
+
+    virtual void submit(int fd, uint64_t offset, ByteBuffer data, bool sync, Completion done) = 0;
+
+    // Blocks until every submitted batch has completed.
+    virtual void drain() = 0;
+
+    virtual const char* backendName() const noexcept = 0;
+
+protected:
+    // Synchronous write path shared by the fallback backend and by io_uring
+    // batches that need to be finished after a short write.
+    static int writeFully(int fd, uint64_t offset, const ByteBuffer& data, size_t from, bool sync) {
+        size_t done = from;
+        while (done < data.size()) {
+            const ssize_t n = ::pwrite(fd, data.data() + done, data.size() - done, static_cast<off_t>(offset + done));
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return errno;
+            }
+            done += static_cast<size_t>(n);
+        }
+        if (sync && ::fdatasync(fd) != 0) {
+            return errno;
+        }
+        return 0;
+    }
+
+    // In-flight accounting for drain().
+    void batchStarted() {
+        std::lock_guard<std::mutex> lock(inflight_mutex_);
+        ++inflight_;
+    }
+
+    void batchFinished() {
+        {
+            std::lock_guard<std::mutex> lock(inflight_mutex_);
+            --inflight_;
+        }
+        inflight_cv_.notify_all();
+    }
+
+    void waitForInflight() {
+        std::unique_lock<std::mutex> lock(inflight_mutex_);
+        inflight_cv_.wait(lock, [this] { return inflight_ == 0; });
+    }
+
+private:
+    std::mutex inflight_mutex_;
+    std::condition_variable inflight_cv_;
+    size_t inflight_ = 0;
+};
+
+// Fallback backend: each batch is a pwrite (+ fdatasync) task on a thread pool.
+class ThreadPoolFileWriter : public AsyncFileWriter {
+public:
+    explicit ThreadPoolFileWriter(size_t threads = 2) : pool_(threads) {}
+
+    ~ThreadPoolFileWriter() override {
+        drain();
+    }
+
+    void submit(int fd, uint64_t offset, ByteBuffer data, bool sync, Completion done) override {
+        batchStarted();
+        try {
+            pool_.submit([this, fd, offset, sync, data = std::move(data), done = std::move(done)] {
+                const int error = writeFully(fd, offset, data, 0, sync);
+                if (done) {
+                    done(error);
+                }
+                batchFinished();
+            });
+        } catch (...) {
+            batchFinished();
+            throw;
+        }
+    }
+
+    void drain() override { waitForInflight(); }
+
+    const char* backendName() const noexcept override { return "thread-pool"; }
+
+private:
+    ThreadPool pool_;
+};
+
+#ifdef OBSERVABLE_HAVE_IO_URING
+
+// io_uring backend using the raw syscalls (no liburing dependency).
+//
+// Each batch becomes a chain of linked SQEs: the write (split into pieces of
+// at most MaxWriteChunk bytes) followed by IORING_OP_FSYNC with
+// IORING_FSYNC_DATASYNC, so one io_uring_enter() queues data and flush
+// without blocking the caller. A reaper thread consumes completions. A short
+// write breaks the link chain; the reaper then finishes that batch with
+// pwrite/fdatasync so callers always see all-or-error.
+//
+// A batch with more operations than the submission queue holds is submitted
+// in segments of at most sq_entries SQEs: the reaper submits the next
+// segment once the previous one has completed, so the trailing fsync still
+// runs after every write of the batch.
+//
+// Batches the submitting thread would otherwise have to finish (nothing to
+// write, or a segment only partly accepted by the kernel) are handed to the
+// reaper with a wake-up NOP.
+class IoUringFileWriter : public AsyncFileWriter {
+public:
+    static constexpr size_t MaxWriteChunk = size_t(64) << 20;
+
+    // Returns nullptr when the kernel (or a seccomp policy) does not provide
+    // io_uring with IORING_OP_WRITE.
+    static std::unique_ptr<IoUringFileWriter> create(unsigned entries = 256) {
+        std::unique_ptr<IoUringFileWriter> writer(new IoUringFileWriter());
+        if (!writer->setup(entries)) {
+            return nullptr;
+        }
+        return writer;
+    }
+
+    ~IoUringFileWriter() override {
+        if (ring_fd_ < 0) {
+            return;
+        }
+        if (reaper_.joinable()) {
+            drain();
+            // A NOP with user_data 0 wakes the reaper and tells it to exit.
+            {
+                std::lock_guard<std::mutex> lock(submit_mutex_);
+                io_uring_sqe* sqe = nextSqe();
+                sqe->opcode = IORING_OP_NOP;
+                sqe->user_data = 0;
+                unsigned unsubmitted = 1;
+                if (enterSubmitted(unsubmitted) != 0) {
+                    std::terminate(); // The reaper could never be stopped
+                }
+            }
+            reaper_.join();
+        }
+        if (sqes_ptr_ != MAP_FAILED) ::munmap(sqes_ptr_, sqes_len_);
+        if (cq_ptr_ != MAP_FAILED && cq_ptr_ != sq_ptr_) ::munmap(cq_ptr_, cq_len_);
+        if (sq_ptr_ != MAP_FAILED) ::munmap(sq_ptr_, sq_len_);
+        ::close(ring_fd_);
+    }
+
+    void submit(int fd, uint64_t offset, ByteBuffer data, bool sync, Completion done) override {
+        auto batch = std::make_unique<Batch>();
+        batch->fd = fd;
+        batch->offset = offset;
+        batch->data = std::move(data);
+        batch->sync = sync;
+        batch->done = std::move(done);
+
+        for (size_t pos = 0; pos < batch->data.size(); pos += MaxWriteChunk) {
+            const size_t length = std::min(MaxWriteChunk, batch->data.size() - pos);
+            batch->ops.push_back(Op{batch.get(), pos, static_cast<uint32_t>(length), false});
+        }
+        if (sync) {
+            batch->ops.push_back(Op{batch.get(), 0, 0, true});
+        }
+        if (batch->ops.empty()) {
+            batch->ops.push_back(Op{batch.get(), 0, 0, false}); // A NOP, so `done` still runs on the reaper
+        }
+
+        // Counted and handed to the reaper before the first SQE is queued:
+        // its completions may arrive before io_uring_enter() returns.
+        batchStarted();
+        Batch* raw = batch.release();
+        bool finish_now = false;
+        int error;
+        {
+            std::lock_guard<std::mutex> lock(submit_mutex_);
+            error = submitSegmentLocked(*raw, finish_now);
+        }
+        if (error != 0) {
+            // Nothing was queued, so the batch is still ours.
+            delete raw;
+            batchFinished();
+            throw std::system_error(error, std::generic_category(), "io_uring_enter");
+        }
+        if (finish_now) {
+            handOff(raw);
+        }
+    }
+
+    void drain() override { waitForInflight(); }
+
+    const char* backendName() const noexcept override { return "io_uring"; }
+
+private:
+    static constexpr uint64_t WakeTag = 1; // user_data of hand-off NOPs; never an Op address
+
+    struct Batch;
+
+    struct Op {
+        Batch* batch;
+        size_t position; // Offset within the batch buffer
+        uint32_t length;
+        bool isSync;
+    };
+
+    struct Batch {
+        int fd = -1;
+        uint64_t offset = 0;
+        ByteBuffer data;
+        bool sync = false;
+        Completion done;
+        std::vector<Op> ops;
+        size_t next = 0;                 // First op of the next segment
+        std::atomic<size_t> pending{0};  // Ops of the current segment still in flight
+        int error = 0;                   // Written by the reaper only
+        std::atomic<bool> incomplete{false}; // Short write or cancelled link: finish synchronously
+    };
+
+    IoUringFileWriter() = default;
+
+    bool setup(unsigned entries) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        const long fd = ::syscall(SYS_io_uring_setup, entries, &params);
+        if (fd < 0) {
+            return false;
+        }
+        ring_fd_ = static_cast<int>(fd);
+        // IORING_FEAT_RW_CUR_POS arrived with IORING_OP_WRITE (Linux 5.6).
+        if ((params.features & IORING_FEAT_RW_CUR_POS) == 0) {
+            return false;
+        }
+
+        sq_len_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_len_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) {
+            sq_len_ = cq_len_ = std::max(sq_len_, cq_len_);
+        }
+        sq_ptr_ = ::mmap(nullptr, sq_len_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+        if (sq_ptr_ == MAP_FAILED) {
+            return false;
+        }
+        cq_ptr_ = single_mmap ? sq_ptr_
+                              : ::mmap(nullptr, cq_len_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+        if (cq_ptr_ == MAP_FAILED) {
+            return false;
+        }
+        sqes_len_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ptr_ = ::mmap(nullptr, sqes_len_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+        if (sqes_ptr_ == MAP_FAILED) {
+            return false;
+        }
+
+        auto* sq = static_cast<char*>(sq_ptr_);
+        sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        sq_entries_ = params.sq_entries;
+        sqes_ = static_cast<io_uring_sqe*>(sqes_ptr_);
+
+        auto* cq = static_cast<char*>(cq_ptr_);
+        cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        reaper_ = std::thread([this] { reapLoop(); });
+        return true;
+    }
+
+    // Caller holds submit_mutex_. Without SQPOLL the kernel consumes every
+    // SQE during io_uring_enter(), so the ring is empty between submissions.
+    io_uring_sqe* nextSqe() {
+        const unsigned index = sq_tail_local_ & sq_mask_;
+        io_uring_sqe* sqe = &sqes_[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sq_array_[index] = index;
+        ++sq_tail_local_;
+        return sqe;
+    }
+
+    // Publishes the queued SQEs and submits `unsubmitted` of them. Returns 0,
+    // or the errno that stopped submission with `unsubmitted` SQEs left in
+    // the ring. Caller holds submit_mutex_.
+    int enterSubmitted(unsigned& unsubmitted) {
+        __atomic_store_n(sq_tail_, sq_tail_local_, __ATOMIC_RELEASE);
+        while (unsubmitted > 0) {
+            const long submitted = ::syscall(SYS_io_uring_enter, ring_fd_, unsubmitted, 0, 0, nullptr, 0);
+            if (submitted < 0) {
+                if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                return errno;
+            }
+            unsubmitted -= static_cast<unsigned>(submitted);
+        }
+        return 0;
+    }
+
+    // Queues the batch's next segment as one link chain. Returns the errno
+    // if none of it could be submitted (the SQEs are taken back and the
+    // batch is unchanged). If only part of it was submitted, the batch is
+    // marked incomplete, and `finishNow` is set when those parts have
+    // already completed and the batch must be finished on the reaper. Caller holds
+    // submit_mutex_.
+    int submitSegmentLocked(Batch& batch, bool& finishNow) {
+        const size_t first = batch.next;
+        const size_t last = std::min(batch.ops.size(), first + sq_entries_);
+        const unsigned count = static_cast<unsigned>(last - first);
+        batch.pending.store(count);
+        for (size_t i = first; i < last; ++i) {
+            Op& op = batch.ops[i];
+            io_uring_sqe* sqe = nextSqe();
+            sqe->fd = batch.fd;
+            sqe->user_data = reinterpret_cast<uint64_t>(&op);
+            if (op.isSync) {
+                sqe->opcode = IORING_OP_FSYNC;
+                sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+            } else if (op.length == 0) {
+                sqe->opcode = IORING_OP_NOP;
+            } else {
+                sqe->opcode = IORING_OP_WRITE;
+                sqe->addr = reinterpret_cast<uint64_t>(batch.data.data() + op.position);
+                sqe->len = op.length;
+                sqe->off = batch.offset + op.position;
+            }
+            if (i + 1 < last) {
+                sqe->flags = IOSQE_IO_LINK;
+            }
+        }
+        batch.next = last;
+        unsigned unsubmitted = count;
+        const int error = enterSubmitted(unsubmitted);
+        if (error == 0) {
+            return 0;
+        }
+        // Take back the SQEs the kernel did not consume.
+        sq_tail_local_ -= unsubmitted;
+        __atomic_store_n(sq_tail_, sq_tail_local_, __ATOMIC_RELEASE);
+        if (unsubmitted == count) {
+            batch.next = first;
+            return error;
+        }
+        batch.incomplete = true;
+        batch.next = batch.ops.size();
+        finishNow = batch.pending.fetch_sub(unsubmitted) == unsubmitted;
+        return 0;
+    }
+
+    void reapLoop() {
+        while (true) {
+            const unsigned head = *cq_head_;
+            const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+            if (head == tail) {
+                if (!continued_.empty()) {
+                    // With the completion queue drained, submitting cannot
+                    // stall on a completion backlog only this thread clears.
+                    submitContinued();
+                    continue;
+                }
+                ::syscall(SYS_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+                continue;
+            }
+            const io_uring_cqe cqe = cqes_[head & cq_mask_];
+            __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+            if (cqe.user_data == 0) {
+                return; // Shutdown NOP
+            }
+            if (cqe.user_data == WakeTag) {
+                finishHandedOff();
+                continue;
+            }
+            complete(*reinterpret_cast<Op*>(cqe.user_data), cqe.res);
+        }
+    }
+
+    void complete(Op& op, int result) {
+        Batch* batch = op.batch;
+        if (result == -ECANCELED) {
+            batch->incomplete = true; // Link broken by an earlier short write
+        } else if (result < 0) {
+            if (batch->error == 0) batch->error = -result;
+        } else if (!op.isSync && static_cast<uint32_t>(result) < op.length) {
+            batch->incomplete = true;
+        }
+        if (batch->pending.fetch_sub(1) > 1) {
+            return;
+        }
+        if (batch->error == 0 && !batch->incomplete && batch->next < batch->ops.size()) {
+            continued_.push_back(batch);
+            return;
+        }
+        finish(batch);
+    }
+
+    // Reaper: submits the next segment of each batch whose previous segment
+    // completed.
+    void submitContinued() {
+        std::vector<Batch*> batches;
+        batches.swap(continued_);
+        for (Batch* batch : batches) {
+            bool finish_now = false;
+            int error;
+            {
+                std::lock_guard<std::mutex> lock(submit_mutex_);
+                error = submitSegmentLocked(*batch, finish_now);
+            }
+            if (error != 0) {
+                batch->error = error;
+                finish(batch);
+            } else if (finish_now) {
+                finish(batch);
+            }
+        }
+    }
+
+    // Submitting thread: queues a batch for the reaper to finish. Without
+    // the NOP the reaper might sleep forever, so failing to submit it leaves
+    // nothing to recover.
+    void handOff(Batch* batch) {
+        std::lock_guard<std::mutex> lock(submit_mutex_);
+        handed_off_.push_back(batch);
+        io_uring_sqe* sqe = nextSqe();
+        sqe->opcode = IORING_OP_NOP;
+        sqe->user_data = WakeTag;
+        unsigned unsubmitted = 1;
+        if (enterSubmitted(unsubmitted) != 0) {
+            std::terminate(); // The batch could never complete
+        }
+    }
+
+    // Reaper: finishes the batches queued by handOff().
+    void finishHandedOff() {
+        std::vector<Batch*> batches;
+        {
+            std::lock_guard<std::mutex> lock(submit_mutex_);
+            batches.swap(handed_off_);
+        }
+        for (Batch* batch : batches) {
+            finish(batch);
+        }
+    }
+
+    void finish(Batch* batch) {
+        int error = batch->error;
+        if (error == 0 && batch->incomplete) {
+            error = writeFully(batch->fd, batch->offset, batch->data, 0, batch->sync);
+        }
+        if (batch->done) {
+            batch->done(error);
+        }
+        delete batch;
+        batchFinished();
+    }
+
+    int ring_fd_ = -1;
+    void* sq_ptr_ = MAP_FAILED;
+    void* cq_ptr_ = MAP_FAILED;
+    void* sqes_ptr_ = MAP_FAILED;
+    size_t sq_len_ = 0;
+    size_t cq_len_ = 0;
+    size_t sqes_len_ = 0;
+
+    unsigned* sq_tail_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned* sq_array_ = nullptr;
+    unsigned sq_entries_ = 0;
+    unsigned sq_tail_local_ = 0; // Guarded by submit_mutex_
+    io_uring_sqe* sqes_ = nullptr;
+
+    unsigned* cq_head_ = nullptr; // Only the reaper advances it
+    unsigned* cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+
+    std::mutex submit_mutex_;
+    std::vector<Batch*> handed_off_; // Guarded by submit_mutex_: batches for the reaper to finish
+    std::vector<Batch*> continued_;  // Reaper only: batches with a segment left to submit
+    std::thread reaper_;
+};
+
+#endif // OBSERVABLE_HAVE_IO_URING
+
+// Picks io_uring when available, otherwise the thread-pool fallback.
+inline std::unique_ptr<AsyncFileWriter> makeAsyncFileWriter() {
+#ifdef OBSERVABLE_HAVE_IO_URING
+    if (auto writer = IoUringFileWriter::create()) {
+        return writer;
+    }
+#endif
+    return std::make_unique<ThreadPoolFileWriter>();
+}
+
+#endif // ASYNC_FILE_WRITER_H
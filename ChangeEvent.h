@@ -3,6 +3,9 @@
 
 #include <optional> // Required for std::optional
 #include <cstddef>  // Required for size_t
+#include <memory>   // Required for std::shared_ptr
+#include <utility>  // Required for std::move
+#include <vector>   // Required for std::vector
 
 // Define an enum class ChangeType
 enum class ChangeType {
@@ -10,20 +13,50 @@ enum class ChangeType {
     ElementRemoved,
     ElementModified,
     SizeChanged,
-    BatchUpdate // Added new change type
+    BatchUpdate, // Added new change type
+    Permuted     // Elements reordered in place; see ChangeEvent::permutation
 };
 
+// Bitmask of ChangeType values, e.g. for ObservableContainer's EnabledEvents
+// parameter: changeTypeBit(ChangeType::ElementAdded) | changeTypeBit(ChangeType::BatchUpdate)
+using ChangeTypeMask = unsigned int;
+
+constexpr ChangeTypeMask changeTypeBit(ChangeType type) noexcept {
+    return 1u << static_cast<unsigned int>(type);
+}
+
+constexpr ChangeTypeMask AllChangeTypes = ~0u;
+
 // Define a template struct ChangeEvent
 template <typename T>
 struct ChangeEvent {
     // Public member ChangeType type
     ChangeType type;
+    // True on every event of a container call except its last, so an
+    // observer that sees every event can tell which ones a single call
+    // produced (e.g. swap(), extract_range(), with_lock()). Occupies padding
+    // after `type`.
+    bool continues = false;
 
     // Optional members for detailed information
     std::optional<size_t> index;
     std::optional<T> oldValue;
     std::optional<T> newValue;
     std::optional<size_t> newSize; // New field
+    // `count` and `permutation` add 32 bytes to every event on 64-bit
+    // platforms (ChangeEvent<int> is 88 bytes); queues that hold many events
+    // should store CompactChangeEvent or PackedEventBuffer instead.
+    //
+    // Range events: number of consecutive elements starting at `index`.
+    // Set (and old/new values left empty) when a range is added or removed
+    // without per-element events (transfer() or append_range() of move-only
+    // T, or with no observers to receive values), or reordered (Permuted);
+    // absent for single-element events.
+    std::optional<size_t> count;
+    // Permuted events: the elements [index, index + count) were reordered so
+    // that new[index + k] == old[index + (*permutation)[k]]. Shared so that
+    // copies of the event do not copy the permutation.
+    std::shared_ptr<const std::vector<size_t>> permutation;
 
     // Constructor that takes a ChangeType to initialize type
     // And optionally index, old value, new value, and new size
@@ -32,7 +65,7 @@ struct ChangeEvent {
                 std::optional<T> old_v = std::nullopt,
                 std::optional<T> new_v = std::nullopt,
                 std::optional<size_t> new_s = std::nullopt) // New parameter
-        : type(type), index(idx), oldValue(old_v), newValue(new_v), newSize(new_s) {} // Initialize new field
+        : type(type), index(idx), oldValue(std::move(old_v)), newValue(std::move(new_v)), newSize(new_s) {} // Move values in: T may be move-only
 };
 
 #endif // CHANGE_EVENT_H
@@ -0,0 +1,399 @@
+#ifndef CHANGE_JOURNAL_H
+#define CHANGE_JOURNAL_H
+
+#include <cerrno>             // Required for errno, ENOMEM
+#include <condition_variable> // Required for std::condition_variable
+#include <cstdint>            // Required for uint64_t
+#include <deque>              // Required for std::deque
+#include <filesystem>         // Required for std::filesystem::path
+#include <fstream>            // Required for std::ifstream
+#include <functional>         // Required for std::function
+#include <iterator>           // Required for std::istreambuf_iterator
+#include <mutex>              // Required for std::mutex, std::lock_guard
+#include <new>                // Required for std::bad_alloc
+#include <stdexcept>          // Required for std::runtime_error
+#include <string>             // Required for std::string
+#include <system_error>       // Required for std::system_error
+#include <utility>            // Required for std::move
+#include <fcntl.h>            // Required for open
+#include <unistd.h>           // Required for close, fsync, ftruncate
+#include "AsyncFileWriter.h"
+#include "ChangeEvent.h"
+#include "CompactChangeEvent.h"
+#include "ValueCodec.h"
+
+// Durable change log for an ObservableContainer.
+//
+// The journal observes the container and appends each event to an in-memory
+// buffer as a record
+//   [sequence:varint][payload length:varint][PackedEventBuffer payload]
+// Sequence numbers start at 1 and are assigned in dispatch order. Once
+// `flushBytes` are buffered (or on flush()) the buffer is handed to an
+// AsyncFileWriter as one write + fdatasync, so the observer never blocks on
+// disk. When a batch completes, every sequence number up to its last record
+// becomes durable; batches completing out of order are held back until all
+// earlier ones finish, so durableSequence() only ever moves forward over a
+// gap-free prefix. After a write error, or a batch the writer refused to
+// queue, the watermark stops advancing, error() reports the errno and later
+// records are dropped (they could never be replayed past the gap). The
+// failure is never thrown into the container's mutators.
+//
+// Reopening an existing journal continues its sequence; a torn record at the
+// tail (crash mid-write) is truncated away.
+template <typename Container, typename Codec = ValueCodec<typename Container::value_type>>
+class ChangeJournal {
+public:
+    using value_type = typename Container::value_type;
+    using Sequence = uint64_t;
+    using DurableCallback = std::function<void(Sequence)>;
+
+    struct Options {
+        size_t flushBytes = 64 * 1024; // Submit once this much is buffered
+        bool sync = true;              // fdatasync after each batch
+    };
+
+    ChangeJournal(Container& source, std::filesystem::path path, AsyncFileWriter& writer, Options options = Options())
+        : source_(source), path_(std::move(path)), writer_(writer), options_(options) {
+        fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd_ < 0) {
+            throw std::system_error(errno, std::generic_category(), "Cannot open journal " + path_.string());
+        }
+        uint64_t valid_bytes = 0;
+        last_sequence_ = scan(path_, [](Sequence, ChangeEvent<value_type>&&) {}, &valid_bytes);
+        if (::ftruncate(fd_, static_cast<off_t>(valid_bytes)) != 0) {
+            const int error = errno;
+            ::close(fd_);
+            throw std::system_error(error, std::generic_category(), "Cannot truncate journal " + path_.string());
+        }
+        next_offset_ = valid_bytes;
+        durable_sequence_ = last_sequence_;
+        reported_sequence_ = last_sequence_;
+        handle_ = source_.addObserver([this](const ChangeEvent<value_type>& event) { onChange(event); });
+    }
+
+    // Stops recording, submits the remaining buffer and waits for this
+    // journal's outstanding batches.
+    ~ChangeJournal() {
+        source_.removeObserver(handle_);
+        flush();
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return outstanding_ == 0; });
+        }
+        ::close(fd_);
+    }
+
+    ChangeJournal(const ChangeJournal&) = delete;
+    ChangeJournal& operator=(const ChangeJournal&) = delete;
+
+    // Submits buffered records without waiting for them.
+    void flush() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        submitLocked();
+    }
+
+    // Flushes and blocks until `sequence` is durable. Throws std::system_error
+    // if a write failed first.
+    void waitDurable(Sequence sequence) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        submitLocked();
+        cv_.wait(lock, [&] { return durable_sequence_ >= sequence || error_ != 0; });
+        if (durable_sequence_ < sequence) {
+            throw std::system_error(error_, std::generic_category(), "Journal write failed");
+        }
+    }
+
+    // Called with the new watermark each time it advances, in increasing
+    // order, from an I/O completion thread.
+    void onDurable(DurableCallback callback) {
+        std::lock_guard<std::mutex> lock(callback_mutex_);
+        durable_callback_ = std::move(callback);
+    }
+
+    Sequence lastSequence() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return last_sequence_;
+    }
+
+    Sequence durableSequence() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return durable_sequence_;
+    }
+
+    int error() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return error_;
+    }
+
+    // Decodes every complete record in `path`, calling fn(sequence, event).
+    // Returns the last sequence number (0 for an empty journal).
+    template <typename Fn>
+    static Sequence replay(const std::filesystem::path& path, Fn&& fn) {
+        return scan(path, std::forward<Fn>(fn), nullptr);
+    }
+
+private:
+    struct PendingBatch {
+        Sequence last;
+        bool done = false;
+        int error = 0;
+    };
+
+    void onChange(const ChangeEvent<value_type>& event) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        record_.clear();
+        PackedEventBuffer<value_type, Codec>::encodeEvent(record_, event);
+        ByteIO::appendVarint(buffer_, ++last_sequence_);
+        ByteIO::appendVarint(buffer_, record_.size());
+        buffer_.insert(buffer_.end(), record_.begin(), record_.end());
+        if (buffer_.size() >= options_.flushBytes) {
+            submitLocked();
+        }
+    }
+
+    // Caller holds mutex_. Submission only queues the I/O; the writer never
+    // runs the completion (which takes mutex_) on this thread.
+    void submitLocked() {
+        if (buffer_.empty()) {
+            return;
+        }
+        if (error_ != 0) {
+            buffer_.clear();
+            return;
+        }
+        ByteBuffer data;
+        data.swap(buffer_);
+        const uint64_t offset = next_offset_;
+        next_offset_ += data.size();
+        const Sequence batch_id = first_batch_id_ + batches_.size();
+        batches_.push_back(PendingBatch{last_sequence_});
+        ++outstanding_;
+        try {
+            writer_.submit(fd_, offset, std::move(data), options_.sync,
+                           [this, batch_id](int error) { onBatchComplete(batch_id, error); });
+        } catch (const std::system_error& e) {
+            rollBackSubmissionLocked(offset, e.code().value());
+        } catch (const std::bad_alloc&) {
+            rollBackSubmissionLocked(offset, ENOMEM);
+        }
+    }
+
+    // Undoes the bookkeeping of a batch the writer refused, so no completion
+    // is awaited and no hole is left at `offset`.
+    void rollBackSubmissionLocked(uint64_t offset, int error) {
+        batches_.pop_back();
+        --outstanding_;
+        next_offset_ = offset;
+        error_ = error;
+        cv_.notify_all();
+    }
+
+    void onBatchComplete(Sequence batch_id, int error) {
+        Sequence durable = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            PendingBatch& batch = batches_[batch_id - first_batch_id_];
+            batch.done = true;
+            batch.error = error;
+            while (!batches_.empty() && batches_.front().done && error_ == 0) {
+                if (batches_.front().error != 0) {
+                    error_ = batches_.front().error;
+                    break;
+                }
+                durable_sequence_ = batches_.front().last;
+                batches_.pop_front();
+                ++first_batch_id_;
+            }
+            durable = durable_sequence_;
+        }
+        {
+            std::lock_guard<std::mutex> lock(callback_mutex_);
+            if (durable > reported_sequence_) {
+                reported_sequence_ = durable;
+                if (durable_callback_) {
+                    durable_callback_(durable);
+                }
+            }
+        }
+        // Notify under the lock: once outstanding_ hits zero the destructor
+        // may run, so nothing may touch *this after the unlock.
+        std::lock_guard<std::mutex> lock(mutex_);
+        --outstanding_;
+        cv_.notify_all();
+    }
+
+    // Walks the records of `path`; stops at the first torn or out-of-order
+    // record and reports the length of the valid prefix in `valid_bytes`.
+    template <typename Fn>
+    static Sequence scan(const std::filesystem::path& path, Fn&& fn, uint64_t* valid_bytes) {
+        std::ifstream in(path, std::ios::binary);
+        const ByteBuffer bytes(std::istreambuf_iterator<char>(in), (std::istreambuf_iterator<char>()));
+        const uint8_t* const begin = bytes.data();
+        const uint8_t* const end = begin + bytes.size();
+        const uint8_t* cursor = begin;
+        Sequence last = 0;
+        while (cursor != end) {
+            const uint8_t* record_start = cursor;
+            try {
+                const Sequence sequence = ByteIO::readVarint(cursor, end);
+                const uint64_t length = ByteIO::readVarint(cursor, end);
+                if ((last != 0 && sequence != last + 1) || sequence == 0 ||
+                    static_cast<uint64_t>(end - cursor) < length) {
+                    cursor = record_start;
+                    break;
+                }
+                const uint8_t* payload = cursor;
+                const uint8_t* payload_end = cursor + length;
+                ChangeEvent<value_type> event = PackedEventBuffer<value_type, Codec>::decodeEvent(payload, payload_end);
+                cursor = payload_end;
+                last = sequence;
+                fn(sequence, std::move(event));
+            } catch (const std::runtime_error&) {
+                cursor = record_start;
+                break;
+            }
+        }
+        if (valid_bytes) {
+            *valid_bytes = static_cast<uint64_t>(cursor - begin);
+        }
+        return last;
+    }
+
+    Container& source_;
+    std::filesystem::path path_;
+    AsyncFileWriter& writer_;
+    Options options_;
+    int fd_ = -1;
+    typename Container::ObserverHandle handle_ = 0;
+
+    mutable std::mutex mutex_; // Guards everything below except the callback state
+    std::condition_variable cv_;
+    ByteBuffer buffer_;
+    ByteBuffer record_; // Scratch space for one encoded event
+    uint64_t next_offset_ = 0;
+    Sequence last_sequence_ = 0;
+    Sequence durable_sequence_ = 0;
+    std::deque<PendingBatch> batches_; // Submitted, not yet folded into the watermark
+    Sequence first_batch_id_ = 0;      // Id of batches_.front()
+    size_t outstanding_ = 0;           // Completions not yet returned
+    int error_ = 0;
+
+    std::mutex callback_mutex_; // Serializes watermark callbacks
+    DurableCallback durable_callback_;
+    Sequence reported_sequence_ = 0;
+};
+
+// Full snapshots written through an AsyncFileWriter. The file holds
+//   ["OSNP"][version:varint][journal sequence:varint][count:varint][values]
+// and is written to `<path>.tmp`, synced, then renamed over `path` and the
+// directory synced, so a reader only ever sees complete snapshots and a
+// completed snapshot survives power loss. Pairing the snapshot with the
+// journal's lastSequence() lets recovery load it and replay only later
+// records. Like Checkpointer, the container is read through its iterators:
+// structural writers must be quiescent while writeSnapshot() encodes.
+template <typename Container, typename Codec = ValueCodec<typename Container::value_type>>
+class SnapshotWriter {
+public:
+    using Sequence = uint64_t;
+
+    explicit SnapshotWriter(AsyncFileWriter& writer) : writer_(writer) {}
+
+    // Encodes the container now and writes it asynchronously; `done` receives
+    // 0 or an errno once the snapshot is renamed into place and durable.
+    // Throws std::system_error if the file cannot be created or the writer
+    // refuses the write; `done` is then never called.
+    void writeSnapshot(const Container& source, const std::filesystem::path& path, Sequence sequence,
+                       AsyncFileWriter::Completion done) {
+        ByteBuffer bytes;
+        ByteIO::appendBytes(bytes, "OSNP", 4);
+        ByteIO::appendVarint(bytes, 1);
+        ByteIO::appendVarint(bytes, sequence);
+        ByteIO::appendVarint(bytes, source.size());
+        for (auto it = source.cbegin(); it != source.cend(); ++it) {
+            Codec::encode(bytes, *it);
+        }
+
+        std::filesystem::path tmp_path = path;
+        tmp_path += ".tmp";
+        FileGuard file(::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644));
+        if (file.fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "Cannot create snapshot " + tmp_path.string());
+        }
+        const int fd = file.fd;
+        writer_.submit(fd, 0, std::move(bytes), true,
+                       [fd, tmp_path, path, done = std::move(done)](int error) {
+                           ::close(fd);
+                           if (error == 0) {
+                               std::error_code ec;
+                               std::filesystem::rename(tmp_path, path, ec);
+                               error = ec ? ec.value() : syncParentDirectory(path);
+                           }
+                           if (done) {
+                               done(error);
+                           }
+                       });
+        file.fd = -1; // Submitted: the completion closes it
+    }
+
+    // Replaces the contents of `target` with the snapshot (one BatchUpdate)
+    // and returns the journal sequence it was taken at.
+    static Sequence load(const std::filesystem::path& path, Container& target) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("Cannot open snapshot " + path.string());
+        }
+        const ByteBuffer bytes(std::istreambuf_iterator<char>(in), (std::istreambuf_iterator<char>()));
+        const uint8_t* cursor = bytes.data();
+        const uint8_t* end = cursor + bytes.size();
+        char magic[4];
+        ByteIO::readBytes(cursor, end, magic, sizeof(magic));
+        if (std::string(magic, sizeof(magic)) != "OSNP" || ByteIO::readVarint(cursor, end) != 1) {
+            throw std::runtime_error("Unsupported snapshot format");
+        }
+        const Sequence sequence = ByteIO::readVarint(cursor, end);
+        const uint64_t count = ByteIO::readVarint(cursor, end);
+        target.beginUpdate();
+        try {
+            target.clear();
+            for (uint64_t i = 0; i < count; ++i) {
+                target.push_back(Codec::decode(cursor, end));
+            }
+        } catch (...) {
+            target.endUpdate();
+            throw;
+        }
+        target.endUpdate();
+        return sequence;
+    }
+
+private:
+    // Closes the temporary file if submit() throws before the completion
+    // takes it over.
+    struct FileGuard {
+        explicit FileGuard(int descriptor) noexcept : fd(descriptor) {}
+        ~FileGuard() {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+        FileGuard(const FileGuard&) = delete;
+        FileGuard& operator=(const FileGuard&) = delete;
+        int fd;
+    };
+
+    // Makes the rename durable (as Checkpointer does); 0 or an errno.
+    static int syncParentDirectory(const std::filesystem::path& path) noexcept {
+        const std::filesystem::path parent = path.has_parent_path() ? path.parent_path() : ".";
+        const int fd = ::open(parent.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) {
+            return errno;
+        }
+        const int error = ::fsync(fd) == 0 ? 0 : errno;
+        ::close(fd);
+        return error;
+    }
+
+    AsyncFileWriter& writer_;
+};
+
+#endif // CHANGE_JOURNAL_H
@@ -0,0 +1,354 @@
+#ifndef CHECKPOINTER_H
+#define CHECKPOINTER_H
+
+#include <algorithm>   // Required for std::min
+#include <cerrno>      // Required for errno, EINTR
+#include <cstdint>     // Required for uint64_t
+#include <filesystem>  // Required for std::filesystem::path
+#include <fstream>     // Required for std::ifstream
+#include <iterator>    // Required for std::advance
+#include <mutex>       // Required for std::mutex, std::lock_guard
+#include <sstream>     // Required for std::ostringstream
+#include <stdexcept>   // Required for std::runtime_error
+#include <string>      // Required for std::string
+#include <system_error> // Required for std::system_error
+#include <unordered_set> // Required for std::unordered_set
+#include <vector>      // Required for std::vector
+#include <fcntl.h>     // Required for open, O_DIRECTORY
+#include <unistd.h>    // Required for write, fsync, close
+#include "ChangeEvent.h"
+#include "DirtyRangeTracker.h"
+#include "ValueCodec.h"
+
+// Incremental checkpoints of an ObservableContainer.
+//
+// The container is split into fixed-size chunks of `chunkSize` elements. An
+// observer maps every change event to the chunks it touched, so checkpoint()
+// only rewrites those chunks plus a small manifest: its cost is proportional
+// to churn, not to the container size.
+//
+// On-disk layout inside `directory`:
+//   manifest                   text: generation, chunk size, element count and
+//                              the generation of the file holding each chunk
+//   chunk_<index>_<gen>.bin    varint element count + Codec-encoded elements
+// A new manifest is written to a temporary file and renamed over the old one,
+// so a crash mid-checkpoint leaves the previous checkpoint loadable. To hold
+// across power loss as well, every chunk file and the temporary manifest are
+// fsync'ed before the rename, and the directory before and after it, so the
+// renamed manifest never references chunks that did not reach the disk.
+// Chunk files no longer referenced by the manifest are removed afterwards.
+//
+// checkpoint() reads the container through its iterators; structural changes
+// must not run concurrently with it.
+template <typename Container, typename Codec = ValueCodec<typename Container::value_type>>
+class Checkpointer {
+public:
+    using value_type = typename Container::value_type;
+
+    struct Result {
+        uint64_t generation = 0;
+        size_t chunksWritten = 0;
+        size_t bytesWritten = 0;
+    };
+
+    struct Manifest {
+        uint64_t generation = 0;
+        size_t chunkSize = 0;
+        size_t elementCount = 0;
+        std::vector<uint64_t> chunkGenerations; // File generation per chunk
+    };
+
+    Checkpointer(Container& source, std::filesystem::path directory, size_t chunkSize = 65536)
+        : source_(source), directory_(std::move(directory)), chunk_size_(chunkSize),
+          tracker_(source.size()) {
+        if (chunk_size_ == 0) {
+            throw std::invalid_argument("Checkpointer chunk size must be positive");
+        }
+        std::filesystem::create_directories(directory_);
+        // Continue the generation sequence of an existing checkpoint so new
+        // chunk files never overwrite ones its manifest still references.
+        if (std::filesystem::exists(directory_ / "manifest")) {
+            generation_ = readManifest(directory_).generation;
+        }
+        handle_ = source_.addObserver([this](const ChangeEvent<value_type>& event) { onChange(event); });
+    }
+
+    ~Checkpointer() {
+        source_.removeObserver(handle_);
+    }
+
+    Checkpointer(const Checkpointer&) = delete;
+    Checkpointer& operator=(const Checkpointer&) = delete;
+
+    // Writes every chunk changed since the previous checkpoint (all chunks on
+    // the first call) and a new manifest.
+    Result checkpoint() {
+        std::vector<bool> dirty;
+        bool all_dirty = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            dirty.swap(dirty_);
+            all_dirty = all_dirty_;
+            all_dirty_ = false;
+        }
+
+        Result result;
+        try {
+            result = writeCheckpoint(dirty, all_dirty);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            all_dirty_ = true; // Unknown which chunk files made it to disk
+            throw;
+        }
+        return result;
+    }
+
+    // Number of chunks that the next checkpoint() will rewrite.
+    size_t dirtyChunkCount() const {
+        const size_t chunk_count = chunkCountFor(source_.size());
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t count = 0;
+        for (size_t c = 0; c < chunk_count; ++c) {
+            if (all_dirty_ || c >= chunk_generations_.size() || (c < dirty_.size() && dirty_[c])) {
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    size_t chunkSize() const noexcept { return chunk_size_; }
+
+    static Manifest readManifest(const std::filesystem::path& directory) {
+        std::ifstream in(directory / "manifest");
+        if (!in) {
+            throw std::runtime_error("Cannot open checkpoint manifest in " + directory.string());
+        }
+        Manifest manifest;
+        std::string magic;
+        unsigned version = 0;
+        std::string key;
+        size_t chunk_count = 0;
+        in >> magic >> version;
+        if (magic != "observable-checkpoint" || version != 1) {
+            throw std::runtime_error("Unsupported checkpoint manifest format");
+        }
+        in >> key >> manifest.generation >> key >> manifest.chunkSize
+           >> key >> manifest.elementCount >> key >> chunk_count;
+        manifest.chunkGenerations.resize(chunk_count);
+        for (auto& generation : manifest.chunkGenerations) {
+            in >> generation;
+        }
+        if (!in) {
+            throw std::runtime_error("Truncated checkpoint manifest");
+        }
+        return manifest;
+    }
+
+    // Replaces the contents of `target` with the checkpoint in `directory`.
+    // Observers of `target` receive a single BatchUpdate.
+    static void load(const std::filesystem::path& directory, Container& target) {
+        const Manifest manifest = readManifest(directory);
+        target.beginUpdate();
+        try {
+            target.clear();
+            size_t loaded = 0;
+            for (size_t c = 0; c < manifest.chunkGenerations.size(); ++c) {
+                const ByteBuffer bytes = readFile(chunkPath(directory, c, manifest.chunkGenerations[c]));
+                const uint8_t* cursor = bytes.data();
+                const uint8_t* end = cursor + bytes.size();
+                const uint64_t count = ByteIO::readVarint(cursor, end);
+                for (uint64_t i = 0; i < count; ++i) {
+                    target.push_back(Codec::decode(cursor, end));
+                }
+                loaded += static_cast<size_t>(count);
+            }
+            if (loaded != manifest.elementCount) {
+                throw std::runtime_error("Checkpoint element count does not match its manifest");
+            }
+        } catch (...) {
+            target.endUpdate();
+            throw;
+        }
+        target.endUpdate();
+    }
+
+private:
+    void onChange(const ChangeEvent<value_type>& event) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto range = tracker_.apply(event);
+        if (event.type == ChangeType::BatchUpdate) {
+            // Batches carry no detail: everything may have changed. The
+            // container lock is not held during dispatch, so size() is safe.
+            tracker_.resync(source_.size());
+            all_dirty_ = true;
+            return;
+        }
+        if (!range || range->empty()) {
+            return;
+        }
+        if (range->last == DirtyRangeTracker::Unbounded) {
+            all_dirty_ = true;
+            return;
+        }
+        const size_t first_chunk = range->first / chunk_size_;
+        const size_t last_chunk = (range->last - 1) / chunk_size_;
+        if (dirty_.size() <= last_chunk) {
+            dirty_.resize(last_chunk + 1, false);
+        }
+        for (size_t c = first_chunk; c <= last_chunk; ++c) {
+            dirty_[c] = true;
+        }
+    }
+
+    Result writeCheckpoint(const std::vector<bool>& dirty, bool all_dirty) {
+        Result result;
+        result.generation = generation_ + 1;
+
+        const size_t element_count = source_.size();
+        const size_t chunk_count = chunkCountFor(element_count);
+        std::vector<uint64_t> chunk_generations = chunk_generations_;
+        chunk_generations.resize(chunk_count, 0);
+
+        // Walk the container once, in chunk order, writing the dirty chunks.
+        auto it = source_.cbegin();
+        size_t position = 0;
+        ByteBuffer bytes;
+        for (size_t c = 0; c < chunk_count; ++c) {
+            const bool is_dirty = all_dirty || c >= chunk_generations_.size() || (c < dirty.size() && dirty[c]);
+            if (!is_dirty) {
+                continue;
+            }
+            const size_t begin = c * chunk_size_;
+            const size_t end = std::min(begin + chunk_size_, element_count);
+            std::advance(it, begin - position);
+            position = begin;
+
+            bytes.clear();
+            ByteIO::appendVarint(bytes, end - begin);
+            for (; position < end; ++position, ++it) {
+                Codec::encode(bytes, *it);
+            }
+            writeFile(chunkPath(directory_, c, result.generation), bytes);
+            chunk_generations[c] = result.generation;
+            ++result.chunksWritten;
+            result.bytesWritten += bytes.size();
+        }
+
+        if (result.chunksWritten > 0) {
+            syncDirectory(directory_); // New chunk entries are durable before the manifest names them
+        }
+        writeManifest(result.generation, element_count, chunk_generations);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            chunk_generations_ = std::move(chunk_generations);
+        }
+        generation_ = result.generation;
+        removeUnreferencedChunks();
+        return result;
+    }
+
+    void writeManifest(uint64_t generation, size_t element_count, const std::vector<uint64_t>& chunk_generations) {
+        const auto tmp_path = directory_ / "manifest.tmp";
+        std::ostringstream out;
+        out << "observable-checkpoint 1\n"
+            << "generation " << generation << '\n'
+            << "chunk_size " << chunk_size_ << '\n'
+            << "elements " << element_count << '\n'
+            << "chunks " << chunk_generations.size() << '\n';
+        for (uint64_t chunk_generation : chunk_generations) {
+            out << chunk_generation << '\n';
+        }
+        const std::string text = out.str();
+        writeFile(tmp_path, reinterpret_cast<const uint8_t*>(text.data()), text.size());
+        std::filesystem::rename(tmp_path, directory_ / "manifest");
+        syncDirectory(directory_);
+    }
+
+    void removeUnreferencedChunks() {
+        std::unordered_set<std::string> referenced;
+        for (size_t c = 0; c < chunk_generations_.size(); ++c) {
+            referenced.insert(chunkPath(directory_, c, chunk_generations_[c]).filename().string());
+        }
+        for (const auto& entry : std::filesystem::directory_iterator(directory_)) {
+            const std::string name = entry.path().filename().string();
+            if (name.rfind("chunk_", 0) == 0 && referenced.count(name) == 0) {
+                std::error_code ignored;
+                std::filesystem::remove(entry.path(), ignored);
+            }
+        }
+    }
+
+    size_t chunkCountFor(size_t element_count) const noexcept {
+        return (element_count + chunk_size_ - 1) / chunk_size_;
+    }
+
+    static std::filesystem::path chunkPath(const std::filesystem::path& directory, size_t chunk, uint64_t generation) {
+        return directory / ("chunk_" + std::to_string(chunk) + "_" + std::to_string(generation) + ".bin");
+    }
+
+    static void writeFile(const std::filesystem::path& path, const ByteBuffer& bytes) {
+        writeFile(path, bytes.data(), bytes.size());
+    }
+
+    // Writes and fsyncs `path`; throws std::system_error on failure.
+    static void writeFile(const std::filesystem::path& path, const uint8_t* data, size_t size) {
+        const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "Cannot create " + path.string());
+        }
+        size_t done = 0;
+        int error = 0;
+        while (done < size && error == 0) {
+            const ssize_t n = ::write(fd, data + done, size - done);
+            if (n >= 0) {
+                done += static_cast<size_t>(n);
+            } else if (errno != EINTR) {
+                error = errno;
+            }
+        }
+        if (error == 0 && ::fsync(fd) != 0) {
+            error = errno;
+        }
+        ::close(fd);
+        if (error != 0) {
+            throw std::system_error(error, std::generic_category(), "Failed to write " + path.string());
+        }
+    }
+
+    // Makes the directory's entries (created and renamed files) durable.
+    static void syncDirectory(const std::filesystem::path& directory) {
+        const int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "Cannot open " + directory.string());
+        }
+        const int error = ::fsync(fd) == 0 ? 0 : errno;
+        ::close(fd);
+        if (error != 0) {
+            throw std::system_error(error, std::generic_category(), "Failed to sync " + directory.string());
+        }
+    }
+
+    static ByteBuffer readFile(const std::filesystem::path& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("Cannot open checkpoint chunk " + path.string());
+        }
+        return ByteBuffer(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    Container& source_;
+    std::filesystem::path directory_;
+    size_t chunk_size_;
+    typename Container::ObserverHandle handle_ = 0;
+
+    mutable std::mutex mutex_; // Guards tracker_, dirty_, all_dirty_ and chunk_generations_ updates
+    DirtyRangeTracker tracker_;
+    std::vector<bool> dirty_;
+    bool all_dirty_ = true; // Nothing written yet
+    std::vector<uint64_t> chunk_generations_;
+
+    // Only touched by checkpoint(); callers serialize checkpoints.
+    uint64_t generation_ = 0;
+};
+
+#endif // CHECKPOINTER_H
@@ -0,0 +1,251 @@
+#ifndef COMPACT_CHANGE_EVENT_H
+#define COMPACT_CHANGE_EVENT_H
+
+#include <cstddef>     // Required for size_t
+#include <cstdint>     // Required for uint8_t
+#include <functional>  // Required for std::function
+#include <memory>      // Required for std::shared_ptr, std::make_shared
+#include <stdexcept>   // Required for std::runtime_error
+#include <type_traits> // Required for std::decay_t, std::is_same_v
+#include <utility>     // Required for std::move
+#include <variant>     // Required for std::variant, std::visit
+#include <vector>      // Required for std::vector
+#include "ChangeEvent.h"
+#include "ValueCodec.h"
+
+// Compact event representations for queued, batched or serialized events.
+//
+// ChangeEvent<T> carries every optional field for every event type. The types
+// below only hold what each event type needs:
+//   - CompactChangeEvent<T>: a std::variant of per-type structs for in-memory
+//     queues of typed events.
+//   - PackedEventBuffer<T>: a packed byte stream (1-byte type, 1-byte field
+//     mask, varint integers, codec-encoded values) for batching/serialization.
+// toCompact()/toChangeEvent() and compactObserver() adapt between these and
+// ChangeEvent<T>, so existing observers keep working.
+
+namespace CompactEvents {
+    template <typename T>
+    struct Added {
+        size_t index;
+        T value;
+    };
+
+    template <typename T>
+    struct Removed {
+        size_t index;
+        T value;
+    };
+
+    template <typename T>
+    struct Modified {
+        size_t index;
+        T oldValue;
+        T newValue;
+    };
+
+    // Element event without (complete) values: ranged events from transfer()
+    // and move-only element events. `count` is 1 for single elements.
+    struct Range {
+        ChangeType type;
+        size_t index;
+        size_t count;
+    };
+
+    struct SizeChanged {
+        size_t newSize;
+    };
+
+    // In-place reordering of [index, index + order.size()); see
+    // ChangeEvent::permutation.
+    struct Permuted {
+        size_t index;
+        std::shared_ptr<const std::vector<size_t>> order;
+    };
+
+    struct Batch {};
+} // namespace CompactEvents
+
+template <typename T>
+using CompactChangeEvent = std::variant<
+    CompactEvents::Batch,
+    CompactEvents::SizeChanged,
+    CompactEvents::Range,
+    CompactEvents::Added<T>,
+    CompactEvents::Removed<T>,
+    CompactEvents::Modified<T>,
+    CompactEvents::Permuted
+>;
+
+// Converts a dispatched ChangeEvent into its compact form (copies the values).
+// Element events missing an index are reported as Batch ("something changed").
+template <typename T>
+CompactChangeEvent<T> toCompact(const ChangeEvent<T>& event) {
+    switch (event.type) {
+        case ChangeType::SizeChanged:
+            return CompactEvents::SizeChanged{event.newSize.value_or(0)};
+        case ChangeType::BatchUpdate:
+            return CompactEvents::Batch{};
+        case ChangeType::Permuted:
+            if (event.index && event.permutation) {
+                return CompactEvents::Permuted{*event.index, event.permutation};
+            }
+            return CompactEvents::Batch{};
+        default:
+            break;
+    }
+    if (!event.index) {
+        return CompactEvents::Batch{};
+    }
+    const size_t index = *event.index;
+    if (!event.count) {
+        if (event.type == ChangeType::ElementAdded && event.newValue) {
+            return CompactEvents::Added<T>{index, *event.newValue};
+        }
+        if (event.type == ChangeType::ElementRemoved && event.oldValue) {
+            return CompactEvents::Removed<T>{index, *event.oldValue};
+        }
+        if (event.type == ChangeType::ElementModified && event.oldValue && event.newValue) {
+            return CompactEvents::Modified<T>{index, *event.oldValue, *event.newValue};
+        }
+    }
+    return CompactEvents::Range{event.type, index, event.count.value_or(1)};
+}
+
+// Expands a compact event back into a ChangeEvent for existing observers.
+template <typename T>
+ChangeEvent<T> toChangeEvent(const CompactChangeEvent<T>& compact) {
+    return std::visit([](const auto& e) -> ChangeEvent<T> {
+        using E = std::decay_t<decltype(e)>;
+        if constexpr (std::is_same_v<E, CompactEvents::Batch>) {
+            return ChangeEvent<T>{ChangeType::BatchUpdate};
+        } else if constexpr (std::is_same_v<E, CompactEvents::SizeChanged>) {
+            return ChangeEvent<T>{ChangeType::SizeChanged, std::nullopt, std::nullopt, std::nullopt, e.newSize};
+        } else if constexpr (std::is_same_v<E, CompactEvents::Range>) {
+            ChangeEvent<T> event{e.type, e.index};
+            if (e.count != 1) {
+                event.count = e.count;
+            }
+            return event;
+        } else if constexpr (std::is_same_v<E, CompactEvents::Added<T>>) {
+            return ChangeEvent<T>{ChangeType::ElementAdded, e.index, std::nullopt, e.value};
+        } else if constexpr (std::is_same_v<E, CompactEvents::Removed<T>>) {
+            return ChangeEvent<T>{ChangeType::ElementRemoved, e.index, e.value, std::nullopt};
+        } else if constexpr (std::is_same_v<E, CompactEvents::Permuted>) {
+            ChangeEvent<T> event{ChangeType::Permuted, e.index};
+            event.count = e.order->size();
+            event.permutation = e.order;
+            return event;
+        } else {
+            return ChangeEvent<T>{ChangeType::ElementModified, e.index, e.oldValue, e.newValue};
+        }
+    }, compact);
+}
+
+// Wraps a callback taking CompactChangeEvent<T> so it can be registered with
+// ObservableContainer::addObserver().
+template <typename T, typename CompactCallback>
+std::function<void(const ChangeEvent<T>&)> compactObserver(CompactCallback callback) {
+    return [callback = std::move(callback)](const ChangeEvent<T>& event) {
+        callback(toCompact(event));
+    };
+}
+
+// Append-only packed event stream. Each event is encoded as
+//   [type:1][field mask:1][index][count][newSize][oldValue][newValue][permutation]
+// where only the fields flagged in the mask are present, integers are varints
+// and values use Codec. A permutation is its length followed by its entries.
+// A SizeChanged event for size < 128 takes 3 bytes.
+template <typename T, typename Codec = ValueCodec<T>>
+class PackedEventBuffer {
+public:
+    enum FieldMask : uint8_t {
+        HasIndex = 1 << 0,
+        HasCount = 1 << 1,
+        HasNewSize = 1 << 2,
+        HasOldValue = 1 << 3,
+        HasNewValue = 1 << 4,
+        HasPermutation = 1 << 5
+    };
+
+    static void encodeEvent(ByteBuffer& out, const ChangeEvent<T>& event) {
+        uint8_t mask = 0;
+        if (event.index) mask |= HasIndex;
+        if (event.count) mask |= HasCount;
+        if (event.newSize) mask |= HasNewSize;
+        if (event.oldValue) mask |= HasOldValue;
+        if (event.newValue) mask |= HasNewValue;
+        if (event.permutation) mask |= HasPermutation;
+        out.push_back(static_cast<uint8_t>(event.type));
+        out.push_back(mask);
+        if (event.index) ByteIO::appendVarint(out, *event.index);
+        if (event.count) ByteIO::appendVarint(out, *event.count);
+        if (event.newSize) ByteIO::appendVarint(out, *event.newSize);
+        if (event.oldValue) Codec::encode(out, *event.oldValue);
+        if (event.newValue) Codec::encode(out, *event.newValue);
+        if (event.permutation) {
+            ByteIO::appendVarint(out, event.permutation->size());
+            for (size_t source : *event.permutation) {
+                ByteIO::appendVarint(out, source);
+            }
+        }
+    }
+
+    // Decodes one event and advances `cursor`. Throws std::runtime_error on
+    // truncated or malformed input.
+    static ChangeEvent<T> decodeEvent(const uint8_t*& cursor, const uint8_t* end) {
+        if (end - cursor < 2) throw std::runtime_error("Truncated event header");
+        if (*cursor > static_cast<uint8_t>(ChangeType::Permuted)) throw std::runtime_error("Unknown event type");
+        const auto type = static_cast<ChangeType>(*cursor++);
+        const uint8_t mask = *cursor++;
+        ChangeEvent<T> event{type};
+        if (mask & HasIndex) event.index = static_cast<size_t>(ByteIO::readVarint(cursor, end));
+        if (mask & HasCount) event.count = static_cast<size_t>(ByteIO::readVarint(cursor, end));
+        if (mask & HasNewSize) event.newSize = static_cast<size_t>(ByteIO::readVarint(cursor, end));
+        if (mask & HasOldValue) event.oldValue.emplace(Codec::decode(cursor, end));
+        if (mask & HasNewValue) event.newValue.emplace(Codec::decode(cursor, end));
+        if (mask & HasPermutation) {
+            const auto length = ByteIO::readVarint(cursor, end);
+            if (length > static_cast<uint64_t>(end - cursor)) {
+                throw std::runtime_error("Truncated permutation"); // Each entry takes at least one byte
+            }
+            auto permutation = std::make_shared<std::vector<size_t>>(static_cast<size_t>(length));
+            for (size_t& source : *permutation) {
+                source = static_cast<size_t>(ByteIO::readVarint(cursor, end));
+            }
+            event.permutation = std::move(permutation);
+        }
+        return event;
+    }
+
+    void append(const ChangeEvent<T>& event) {
+        encodeEvent(bytes_, event);
+        ++event_count_;
+    }
+
+    // Decodes every buffered event in order and passes it to `fn`.
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        const uint8_t* cursor = bytes_.data();
+        const uint8_t* end = cursor + bytes_.size();
+        while (cursor != end) {
+            fn(decodeEvent(cursor, end));
+        }
+    }
+
+    size_t size() const noexcept { return event_count_; }
+    bool empty() const noexcept { return event_count_ == 0; }
+    size_t byteSize() const noexcept { return bytes_.size(); }
+    const ByteBuffer& bytes() const noexcept { return bytes_; }
+
+    void clear() noexcept {
+        bytes_.clear();
+        event_count_ = 0;
+    }
+
+private:
+    ByteBuffer bytes_;
+    size_t event_count_ = 0;
+};
+
+#endif // COMPACT_CHANGE_EVENT_H
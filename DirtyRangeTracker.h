@@ -0,0 +1,77 @@
+#ifndef DIRTY_RANGE_TRACKER_H
+#define DIRTY_RANGE_TRACKER_H
+
+#include <algorithm> // Required for std::min, std::max
+#include <cstddef>   // Required for size_t
+#include <limits>    // Required for std::numeric_limits
+#include <optional>  // Required for std::optional
+#include "ChangeEvent.h"
+
+// Half-open range of element positions [first, last).
+struct IndexRange {
+    size_t first = 0;
+    size_t last = 0;
+
+    bool empty() const noexcept { return first >= last; }
+};
+
+// Maps ChangeEvents to the positions whose contents they changed, following
+// the container's size as events arrive. Inserting or removing at `i` shifts
+// every later element, so the affected range runs to the old/new end.
+// Used to derive dirty chunks (Checkpointer) and dirty pages.
+class DirtyRangeTracker {
+public:
+    static constexpr size_t Unbounded = std::numeric_limits<size_t>::max();
+
+    explicit DirtyRangeTracker(size_t initialSize = 0) : size_(initialSize) {}
+
+    // Returns the affected positions, or std::nullopt if nothing changed.
+    // BatchUpdate carries no detail and yields [0, Unbounded); call resync()
+    // with the container's current size afterwards.
+    template <typename T>
+    std::optional<IndexRange> apply(const ChangeEvent<T>& event) {
+        switch (event.type) {
+            case ChangeType::Permuted:
+            case ChangeType::ElementModified:
+                if (event.index) {
+                    return IndexRange{*event.index, *event.index + event.count.value_or(1)};
+                }
+                break;
+            case ChangeType::ElementAdded:
+                if (event.index) {
+                    size_ += event.count.value_or(1);
+                    return IndexRange{*event.index, size_};
+                }
+                break;
+            case ChangeType::ElementRemoved:
+                if (event.index) {
+                    const size_t old_size = size_;
+                    const size_t removed = event.count.value_or(1);
+                    size_ = removed < size_ ? size_ - removed : 0;
+                    return IndexRange{*event.index, std::max(old_size, *event.index + removed)};
+                }
+                break;
+            case ChangeType::SizeChanged:
+                // Element events already tracked the size; this catches
+                // detail-less size changes such as clear().
+                if (event.newSize && *event.newSize != size_) {
+                    IndexRange range{std::min(size_, *event.newSize), std::max(size_, *event.newSize)};
+                    size_ = *event.newSize;
+                    return range;
+                }
+                return std::nullopt;
+            default:
+                break;
+        }
+        return IndexRange{0, Unbounded};
+    }
+
+    void resync(size_t currentSize) noexcept { size_ = currentSize; }
+
+    size_t size() const noexcept { return size_; }
+
+private:
+    size_t size_;
+};
+
+#endif // DIRTY_RANGE_TRACKER_H
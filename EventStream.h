@@ -0,0 +1,646 @@
+#ifndef EVENT_STREAM_H
+#define EVENT_STREAM_H
+
+#include <algorithm>   // Required for std::min
+#include <cerrno>      // Required for errno
+#include <cstdint>     // Required for uint8_t, uint64_t
+#include <cstring>     // Required for std::memset, std::strncpy
+#include <iterator>    // Required for std::next
+#include <mutex>       // Required for std::mutex, std::lock_guard
+#include <stdexcept>   // Required for std::runtime_error
+#include <string>      // Required for std::string
+#include <system_error> // Required for std::system_error
+#include <utility>     // Required for std::move
+#include <vector>      // Required for std::vector
+#include <fcntl.h>     // Required for O_NONBLOCK
+#include <poll.h>      // Required for poll
+#include <sys/socket.h> // Required for socket, sendmsg, recvmsg
+#include <sys/uio.h>   // Required for iovec
+#include <sys/un.h>    // Required for sockaddr_un
+#include <unistd.h>    // Required for close, unlink
+#include "ChangeEvent.h"
+#include "CompactChangeEvent.h"
+#include "ValueCodec.h"
+
+// Streaming of ChangeEvents to other processes over a Unix-domain socket.
+//
+// EventPublisher observes a container and listens on a SOCK_SEQPACKET socket.
+// Events are numbered and packed into batches; each batch goes out as one
+// message with a single vectored sendmsg() (header iovec + payload iovec), so
+// the payload is never copied per subscriber. Sends never block dispatch: a
+// subscriber whose queue is full simply misses that batch.
+//
+// No message exceeds what a subscriber's socket accepts (half its effective
+// SO_SNDBUF, read back after Options::sendBufferBytes is applied): a larger
+// batch goes out as several Events messages split at event boundaries, and
+// snapshots are sent in pieces of that size. A snapshot that stops on a full
+// queue resumes at the next pump() from the element where it stopped, unless
+// the container changed in between, in which case it starts over.
+//
+// EventSubscriber connects, receives a snapshot and applies later batches to
+// a local mirror container. A batch whose first sequence number is not the
+// next expected one (a dropped batch), or an event that cannot be replayed
+// (BatchUpdate, value-less events), makes it request a resync: the publisher
+// answers with a fresh snapshot tagged with its current sequence number.
+// Because a dropped final batch is not followed by anything that would
+// reveal the gap, pump() sends a heartbeat carrying the last sequence number
+// to subscribers that missed a batch.
+//
+// Messages (first byte is the kind):
+//   Events        [1][first sequence][count]{[length][packed event]}...
+//   SnapshotBegin [2][sequence][element count]
+//   SnapshotData  [3]{encoded value}...
+//   SnapshotEnd   [4]
+//   Resync        [5]                       (subscriber -> publisher)
+//   Heartbeat     [6][last sequence]
+// Integers are varints; events use PackedEventBuffer, values use Codec.
+namespace EventStreamProtocol {
+    enum MessageKind : uint8_t {
+        Events = 1,
+        SnapshotBegin = 2,
+        SnapshotData = 3,
+        SnapshotEnd = 4,
+        Resync = 5,
+        Heartbeat = 6
+    };
+
+    constexpr size_t MaxMessageBytes = 256 * 1024;
+    // Upper bound of an Events header: kind plus two 64-bit varints.
+    constexpr size_t MaxEventsHeaderBytes = 1 + 2 * 10;
+    // Per-message send buffer overhead of Unix-domain datagram sockets.
+    constexpr size_t SendOverheadBytes = 32;
+
+    inline sockaddr_un socketAddress(const std::string& path) {
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path)) {
+            throw std::invalid_argument("Socket path too long: " + path);
+        }
+        std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+        return address;
+    }
+
+    // Largest message to send on `fd`: half its send buffer, so that one
+    // message can be queued while the previous one is still unread.
+    inline size_t messageLimit(int fd) {
+        int send_buffer = 0;
+        socklen_t length = sizeof(send_buffer);
+        if (::getsockopt(fd, SOL_SOCKET, SO_SNDBUF, &send_buffer, &length) != 0 ||
+            static_cast<size_t>(send_buffer) <= 2 * SendOverheadBytes + MaxEventsHeaderBytes) {
+            return MaxMessageBytes;
+        }
+        return std::min(MaxMessageBytes, (static_cast<size_t>(send_buffer) - SendOverheadBytes) / 2);
+    }
+
+    // Returns 0, or the errno of a failed non-blocking send.
+    inline int sendMessage(int fd, const ByteBuffer& header, const uint8_t* payload, size_t length) {
+        iovec parts[2];
+        parts[0].iov_base = const_cast<uint8_t*>(header.data());
+        parts[0].iov_len = header.size();
+        parts[1].iov_base = const_cast<uint8_t*>(payload);
+        parts[1].iov_len = length;
+        msghdr message;
+        std::memset(&message, 0, sizeof(message));
+        message.msg_iov = parts;
+        message.msg_iovlen = length == 0 ? 1 : 2;
+        while (::sendmsg(fd, &message, MSG_DONTWAIT | MSG_NOSIGNAL) < 0) {
+            if (errno != EINTR) {
+                return errno;
+            }
+        }
+        return 0;
+    }
+
+    inline int sendMessage(int fd, const ByteBuffer& header, const ByteBuffer& payload) {
+        return sendMessage(fd, header, payload.data(), payload.size());
+    }
+
+    inline bool queueFull(int error) {
+        return error == EAGAIN || error == EWOULDBLOCK || error == ENOBUFS;
+    }
+} // namespace EventStreamProtocol
+
+template <typename Container, typename Codec = ValueCodec<typename Container::value_type>>
+class EventPublisher {
+public:
+    using value_type = typename Container::value_type;
+
+    struct Options {
+        size_t maxBatchBytes = 32 * 1024; // Flush a batch once its payload reaches this size
+        int sendBufferBytes = 0;          // SO_SNDBUF per subscriber; bounds its backlog (0: system default)
+    };
+
+    EventPublisher(Container& source, std::string socketPath, Options options = Options())
+        : source_(source), path_(std::move(socketPath)), options_(options) {
+        const sockaddr_un address = EventStreamProtocol::socketAddress(path_);
+        listen_fd_ = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listen_fd_ < 0) {
+            throw std::system_error(errno, std::generic_category(), "socket");
+        }
+        ::unlink(path_.c_str());
+        if (::bind(listen_fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+            ::listen(listen_fd_, 16) != 0) {
+            const int error = errno;
+            ::close(listen_fd_);
+            throw std::system_error(error, std::generic_category(), "Cannot listen on " + path_);
+        }
+        handle_ = source_.addObserver([this](const ChangeEvent<value_type>& event) { onChange(event); });
+    }
+
+    ~EventPublisher() {
+        source_.removeObserver(handle_);
+        for (const Subscriber& subscriber : subscribers_) {
+            ::close(subscriber.fd);
+        }
+        ::close(listen_fd_);
+        ::unlink(path_.c_str());
+    }
+
+    EventPublisher(const EventPublisher&) = delete;
+    EventPublisher& operator=(const EventPublisher&) = delete;
+
+    // Sends the pending batch, accepts new subscribers and answers resync
+    // requests. Snapshots read the container through its iterators, so call
+    // this from the thread that mutates the container (or while it is idle).
+    void pump() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        flushLocked();
+        acceptLocked();
+        readRequestsLocked();
+        for (size_t i = 0; i < subscribers_.size();) {
+            Subscriber& subscriber = subscribers_[i];
+            if (subscriber.needsSnapshot) {
+                const int error = sendSnapshotLocked(subscriber);
+                if (error == EMSGSIZE) {
+                    dropSubscriberLocked(i); // A value larger than its socket accepts
+                    continue;
+                }
+                subscriber.needsSnapshot = error != 0;
+                subscriber.missedBatch = false;
+            } else if (subscriber.missedBatch) {
+                header_.assign(1, EventStreamProtocol::Heartbeat);
+                ByteIO::appendVarint(header_, last_sequence_);
+                subscriber.missedBatch = EventStreamProtocol::sendMessage(subscriber.fd, header_, ByteBuffer()) != 0;
+            }
+            ++i;
+        }
+    }
+
+    // Sends the pending batch without serving requests.
+    void flush() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        flushLocked();
+    }
+
+    size_t subscriberCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return subscribers_.size();
+    }
+
+    uint64_t lastSequence() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return last_sequence_;
+    }
+
+    // Batches not delivered to some subscriber because its queue was full.
+    size_t droppedBatches() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return dropped_batches_;
+    }
+
+private:
+    struct Subscriber {
+        int fd;
+        bool needsSnapshot;
+        bool missedBatch;
+        size_t messageLimit; // See EventStreamProtocol::messageLimit()
+        // Snapshot in progress: SnapshotBegin went out at snapshotSequence
+        // and the elements before snapshotNext were sent.
+        bool snapshotStarted = false;
+        uint64_t snapshotSequence = 0;
+        size_t snapshotNext = 0;
+    };
+
+    void onChange(const ChangeEvent<value_type>& event) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        record_.clear();
+        PackedEventBuffer<value_type, Codec>::encodeEvent(record_, event);
+        if (pending_count_ == 0) {
+            pending_first_ = last_sequence_ + 1;
+        }
+        ++last_sequence_;
+        ++pending_count_;
+        ByteIO::appendVarint(pending_, record_.size());
+        pending_.insert(pending_.end(), record_.begin(), record_.end());
+        record_ends_.push_back(pending_.size());
+        if (pending_.size() >= options_.maxBatchBytes) {
+            flushLocked();
+        }
+    }
+
+    void flushLocked() {
+        if (pending_count_ == 0) {
+            return;
+        }
+        for (size_t i = 0; i < subscribers_.size();) {
+            Subscriber& subscriber = subscribers_[i];
+            if (!subscriber.needsSnapshot) {
+                const int error = sendBatchLocked(subscriber);
+                // EMSGSIZE: one event is larger than the socket accepts; the
+                // subscriber recovers from a snapshot like after a full queue.
+                if (EventStreamProtocol::queueFull(error) || error == EMSGSIZE) {
+                    ++dropped_batches_; // The subscriber sees the gap and resyncs
+                    subscriber.missedBatch = true;
+                } else if (error != 0) {
+                    dropSubscriberLocked(i);
+                    continue;
+                }
+            }
+            ++i;
+        }
+        pending_.clear();
+        record_ends_.clear();
+        pending_count_ = 0;
+    }
+
+    // Sends the pending batch as one message, or as several consecutive
+    // Events messages split at event boundaries if it exceeds the
+    // subscriber's message limit. Returns 0 or the errno of the first
+    // failed send; the later parts are not sent then.
+    int sendBatchLocked(const Subscriber& subscriber) {
+        if (EventStreamProtocol::MaxEventsHeaderBytes + pending_.size() <= subscriber.messageLimit) {
+            setEventsHeader(pending_first_, pending_count_);
+            return EventStreamProtocol::sendMessage(subscriber.fd, header_, pending_);
+        }
+        const size_t capacity = subscriber.messageLimit - EventStreamProtocol::MaxEventsHeaderBytes;
+        size_t begin = 0; // Byte offset of the first record of the part
+        for (size_t first = 0; first < record_ends_.size();) {
+            size_t last = first;
+            while (last < record_ends_.size() && record_ends_[last] - begin <= capacity) {
+                ++last;
+            }
+            if (last == first) {
+                return EMSGSIZE;
+            }
+            setEventsHeader(pending_first_ + first, last - first);
+            const int error = EventStreamProtocol::sendMessage(subscriber.fd, header_, pending_.data() + begin,
+                                                               record_ends_[last - 1] - begin);
+            if (error != 0) {
+                return error;
+            }
+            begin = record_ends_[last - 1];
+            first = last;
+        }
+        return 0;
+    }
+
+    void setEventsHeader(uint64_t first, uint64_t count) {
+        header_.clear();
+        header_.push_back(EventStreamProtocol::Events);
+        ByteIO::appendVarint(header_, first);
+        ByteIO::appendVarint(header_, count);
+    }
+
+    void acceptLocked() {
+        while (true) {
+            const int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                return;
+            }
+            if (options_.sendBufferBytes > 0) {
+                ::setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &options_.sendBufferBytes, sizeof(options_.sendBufferBytes));
+            }
+            // New subscribers start from a snapshot
+            subscribers_.push_back(Subscriber{fd, true, false, EventStreamProtocol::messageLimit(fd)});
+        }
+    }
+
+    void readRequestsLocked() {
+        uint8_t request[16];
+        for (size_t i = 0; i < subscribers_.size();) {
+            bool closed = false;
+            while (true) {
+                const ssize_t n = ::recv(subscribers_[i].fd, request, sizeof(request), MSG_DONTWAIT);
+                if (n > 0) {
+                    if (request[0] == EventStreamProtocol::Resync) {
+                        subscribers_[i].needsSnapshot = true;
+                        subscribers_[i].snapshotStarted = false; // Whatever it received is discarded
+                    }
+                    continue;
+                }
+                closed = n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR);
+                break;
+            }
+            if (closed) {
+                dropSubscriberLocked(i);
+            } else {
+                ++i;
+            }
+        }
+    }
+
+    // Sends the subscriber's snapshot, or the rest of it. Returns 0 once
+    // SnapshotEnd is out; otherwise the errno of the send that failed, and
+    // pump() retries from the first element not yet sent. EMSGSIZE means a
+    // single value exceeds the subscriber's message limit.
+    int sendSnapshotLocked(Subscriber& subscriber) {
+        if (subscriber.snapshotStarted && subscriber.snapshotSequence != last_sequence_) {
+            subscriber.snapshotStarted = false; // The container changed: start over
+        }
+        ByteBuffer header;
+        if (!subscriber.snapshotStarted) {
+            header.push_back(EventStreamProtocol::SnapshotBegin);
+            ByteIO::appendVarint(header, last_sequence_);
+            ByteIO::appendVarint(header, source_.size());
+            if (const int error = EventStreamProtocol::sendMessage(subscriber.fd, header, ByteBuffer())) {
+                return error;
+            }
+            subscriber.snapshotStarted = true;
+            subscriber.snapshotSequence = last_sequence_;
+            subscriber.snapshotNext = 0;
+        }
+        header.assign(1, EventStreamProtocol::SnapshotData);
+        const size_t capacity = subscriber.messageLimit - header.size();
+        const size_t target = std::min(options_.maxBatchBytes, capacity);
+        const size_t size = source_.size();
+        ByteBuffer values;
+        size_t count = 0; // Elements encoded in `values`
+        auto it = std::next(source_.cbegin(), static_cast<std::ptrdiff_t>(subscriber.snapshotNext));
+        for (size_t i = subscriber.snapshotNext; i < size; ++i, ++it) {
+            const size_t before = values.size();
+            Codec::encode(values, *it);
+            if (values.size() - before > capacity) {
+                return EMSGSIZE;
+            }
+            if (values.size() > target && before > 0) {
+                // Send the values before this one; it opens the next piece.
+                if (const int error = EventStreamProtocol::sendMessage(subscriber.fd, header, values.data(), before)) {
+                    return error;
+                }
+                subscriber.snapshotNext += count;
+                count = 0;
+                values.erase(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(before));
+            }
+            ++count;
+        }
+        if (!values.empty()) {
+            if (const int error = EventStreamProtocol::sendMessage(subscriber.fd, header, values)) {
+                return error;
+            }
+            subscriber.snapshotNext += count;
+        }
+        header.assign(1, EventStreamProtocol::SnapshotEnd);
+        if (const int error = EventStreamProtocol::sendMessage(subscriber.fd, header, ByteBuffer())) {
+            return error;
+        }
+        subscriber.snapshotStarted = false;
+        return 0;
+    }
+
+    void dropSubscriberLocked(size_t i) {
+        ::close(subscribers_[i].fd);
+        subscribers_.erase(subscribers_.begin() + static_cast<std::ptrdiff_t>(i));
+    }
+
+    Container& source_;
+    std::string path_;
+    Options options_;
+    int listen_fd_ = -1;
+    typename Container::ObserverHandle handle_ = 0;
+
+    mutable std::mutex mutex_; // Guards everything below
+    std::vector<Subscriber> subscribers_;
+    ByteBuffer pending_; // Length-prefixed packed events of the current batch
+    std::vector<size_t> record_ends_; // End offset in pending_ of each event
+    ByteBuffer record_;  // Scratch space for one encoded event
+    ByteBuffer header_;
+    uint64_t pending_first_ = 0;
+    uint64_t pending_count_ = 0;
+    uint64_t last_sequence_ = 0;
+    size_t dropped_batches_ = 0;
+};
+
+// Receiving side. Not thread-safe: call pump() from one thread, which is
+// also the thread on which the mirror's observers run.
+template <typename Container, typename Codec = ValueCodec<typename Container::value_type>>
+class EventSubscriber {
+public:
+    using value_type = typename Container::value_type;
+
+    EventSubscriber(const std::string& socketPath, Container& mirror)
+        : mirror_(mirror), buffer_(EventStreamProtocol::MaxMessageBytes) {
+        const sockaddr_un address = EventStreamProtocol::socketAddress(socketPath);
+        fd_ = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+        if (fd_ < 0) {
+            throw std::system_error(errno, std::generic_category(), "socket");
+        }
+        if (::connect(fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+            const int error = errno;
+            ::close(fd_);
+            throw std::system_error(error, std::generic_category(), "Cannot connect to " + socketPath);
+        }
+    }
+
+    ~EventSubscriber() {
+        ::close(fd_);
+    }
+
+    EventSubscriber(const EventSubscriber&) = delete;
+    EventSubscriber& operator=(const EventSubscriber&) = delete;
+
+    // Waits up to `timeoutMs` for data, then handles every queued message.
+    // Returns the number of messages handled.
+    size_t pump(int timeoutMs = 0) {
+        pollfd readable{fd_, POLLIN, 0};
+        if (!connected_ || ::poll(&readable, 1, timeoutMs) <= 0) {
+            return 0;
+        }
+        size_t handled = 0;
+        while (true) {
+            iovec part{buffer_.data(), buffer_.size()};
+            msghdr message;
+            std::memset(&message, 0, sizeof(message));
+            message.msg_iov = &part;
+            message.msg_iovlen = 1;
+            const ssize_t n = ::recvmsg(fd_, &message, MSG_DONTWAIT);
+            if (n == 0) {
+                connected_ = false;
+                break;
+            }
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    connected_ = false;
+                }
+                break;
+            }
+            ++handled;
+            if (message.msg_flags & MSG_TRUNC) {
+                requestResync();
+                continue;
+            }
+            handleMessage(buffer_.data(), buffer_.data() + n);
+        }
+        return handled;
+    }
+
+    bool synced() const noexcept { return synced_; }
+    bool connected() const noexcept { return connected_; }
+    uint64_t lastSequence() const noexcept { return last_sequence_; }
+    size_t gapsDetected() const noexcept { return gaps_; }
+    size_t snapshotsApplied() const noexcept { return snapshots_; }
+
+private:
+    void handleMessage(const uint8_t* cursor, const uint8_t* end) {
+        const uint8_t kind = *cursor++;
+        try {
+            switch (kind) {
+                case EventStreamProtocol::Events:
+                    handleEvents(cursor, end);
+                    break;
+                case EventStreamProtocol::Heartbeat:
+                    if (synced_ && ByteIO::readVarint(cursor, end) > last_sequence_) {
+                        ++gaps_;
+                        requestResync();
+                    }
+                    break;
+                case EventStreamProtocol::SnapshotBegin:
+                    snapshot_sequence_ = ByteIO::readVarint(cursor, end);
+                    snapshot_values_.clear();
+                    snapshot_values_.reserve(static_cast<size_t>(ByteIO::readVarint(cursor, end)));
+                    receiving_snapshot_ = true;
+                    break;
+                case EventStreamProtocol::SnapshotData:
+                    while (receiving_snapshot_ && cursor != end) {
+                        snapshot_values_.push_back(Codec::decode(cursor, end));
+                    }
+                    break;
+                case EventStreamProtocol::SnapshotEnd:
+                    if (receiving_snapshot_) {
+                        applySnapshot();
+                    }
+                    break;
+                default:
+                    break;
+            }
+        } catch (const std::runtime_error&) {
+            requestResync(); // Malformed message
+        }
+    }
+
+    void handleEvents(const uint8_t* cursor, const uint8_t* end) {
+        if (!synced_) {
+            return; // Waiting for a snapshot
+        }
+        uint64_t sequence = ByteIO::readVarint(cursor, end);
+        const uint64_t count = ByteIO::readVarint(cursor, end);
+        if (sequence > last_sequence_ + 1) {
+            ++gaps_;
+            requestResync();
+            return;
+        }
+        for (uint64_t i = 0; i < count; ++i, ++sequence) {
+            const uint64_t length = ByteIO::readVarint(cursor, end);
+            if (static_cast<uint64_t>(end - cursor) < length) {
+                throw std::runtime_error("Truncated event record");
+            }
+            const uint8_t* record = cursor;
+            cursor += length;
+            if (sequence <= last_sequence_) {
+                continue; // Already part of the snapshot
+            }
+            ChangeEvent<value_type> event = PackedEventBuffer<value_type, Codec>::decodeEvent(record, cursor);
+            if (!apply(event)) {
+                requestResync();
+                return;
+            }
+            last_sequence_ = sequence;
+        }
+    }
+
+    // Replays one event on the mirror; false if it carries too little detail.
+    bool apply(ChangeEvent<value_type>& event) {
+        switch (event.type) {
+            case ChangeType::ElementAdded:
+                if (event.index && event.newValue && !event.count && *event.index <= mirror_.size()) {
+                    mirror_.insert(std::next(mirror_.cbegin(), static_cast<std::ptrdiff_t>(*event.index)), *event.newValue);
+                    return true;
+                }
+                return false;
+            case ChangeType::ElementRemoved:
+                if (event.index && *event.index + event.count.value_or(1) <= mirror_.size()) {
+                    for (size_t n = event.count.value_or(1); n > 0; --n) {
+                        mirror_.erase(std::next(mirror_.cbegin(), static_cast<std::ptrdiff_t>(*event.index)));
+                    }
+                    return true;
+                }
+                return false;
+            case ChangeType::ElementModified:
+                if (event.index && event.newValue && !event.count && *event.index < mirror_.size()) {
+                    mirror_.modify(*event.index, std::move(*event.newValue));
+                    return true;
+                }
+                return false;
+            case ChangeType::Permuted:
+                if (event.index && event.permutation && *event.index + event.permutation->size() <= mirror_.size()) {
+                    mirror_.permute(*event.index, *event.permutation);
+                    return true;
+                }
+                return false;
+            case ChangeType::SizeChanged:
+                // Consistency check: a mismatch means the mirror diverged.
+                return !event.newSize || *event.newSize == mirror_.size();
+            default:
+                return false; // BatchUpdate: contents unknown
+        }
+    }
+
+    void applySnapshot() {
+        receiving_snapshot_ = false;
+        mirror_.beginUpdate();
+        try {
+            mirror_.clear();
+            for (value_type& value : snapshot_values_) {
+                mirror_.push_back(std::move(value));
+            }
+        } catch (...) {
+            mirror_.endUpdate();
+            throw;
+        }
+        mirror_.endUpdate();
+        snapshot_values_.clear();
+        last_sequence_ = snapshot_sequence_;
+        synced_ = true;
+        resync_requested_ = false;
+        ++snapshots_;
+    }
+
+    void requestResync() {
+        synced_ = false;
+        if (resync_requested_) {
+            return;
+        }
+        const uint8_t request = EventStreamProtocol::Resync;
+        if (::send(fd_, &request, 1, MSG_NOSIGNAL) == 1) {
+            resync_requested_ = true;
+        }
+    }
+
+    Container& mirror_;
+    int fd_ = -1;
+    std::vector<uint8_t> buffer_;
+    bool connected_ = true;
+    bool synced_ = false;
+    bool resync_requested_ = true; // The publisher sends an initial snapshot
+    bool receiving_snapshot_ = false;
+    uint64_t last_sequence_ = 0;
+    uint64_t snapshot_sequence_ = 0;
+    std::vector<value_type> snapshot_values_;
+    size_t gaps_ = 0;
+    size_t snapshots_ = 0;
+};
+
+#endif // EVENT_STREAM_H
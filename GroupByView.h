@@ -0,0 +1,245 @@
+#ifndef GROUP_BY_VIEW_H
+#define GROUP_BY_VIEW_H
+
+#include <cstddef>       // Required for size_t
+#include <functional>    // Required for std::hash
+#include <mutex>         // Required for std::mutex, std::lock_guard
+#include <optional>      // Required for std::optional
+#include <type_traits>   // Required for std::invoke_result_t, std::decay_t
+#include <unordered_map> // Required for std::unordered_map
+#include <utility>       // Required for std::pair, std::move
+#include <vector>        // Required for std::vector
+#include "ChangeEvent.h"
+#include "ViewObservers.h"
+
+// Invertible per-group aggregators for GroupByView. An aggregator defines
+// `State` and add(State&, const T&) / remove(State&, const T&); remove must
+// undo add so that removals and modifications update a group in O(1).
+struct CountAggregator {
+    using State = size_t;
+
+    template <typename T>
+    void add(State& state, const T&) const { ++state; }
+
+    template <typename T>
+    void remove(State& state, const T&) const { --state; }
+};
+
+// Sum of projection(element), accumulated as `Sum`.
+template <typename Projection, typename Sum = double>
+struct SumAggregator {
+    using State = Sum;
+    Projection projection;
+
+    template <typename T>
+    void add(State& state, const T& value) const { state += static_cast<Sum>(projection(value)); }
+
+    template <typename T>
+    void remove(State& state, const T& value) const { state -= static_cast<Sum>(projection(value)); }
+};
+
+template <typename Sum = double, typename Projection>
+SumAggregator<Projection, Sum> sumOf(Projection projection) {
+    return SumAggregator<Projection, Sum>{std::move(projection)};
+}
+
+// Elements of a container grouped by keyFn(element), with one aggregate per
+// group, maintained from the container's events.
+//
+// Element events carry the affected values, so each one is applied in O(1)
+// expected time: the key of an added/removed value selects its group, and a
+// modification whose key changes moves the element between two groups.
+// Groups appear with their first member and disappear with their last.
+//
+// The view is an observable keyed collection of (key, aggregate) pairs. It
+// publishes one event per affected group, without an index: ElementAdded for
+// a new group, ElementRemoved for a group that emptied, ElementModified (old
+// and new aggregate) otherwise. Container events without values (BatchUpdate,
+// ranged or move-only events, clear()) rebuild the grouping and publish one
+// BatchUpdate; the rebuild reads the container through its iterators, so
+// structural writers must be quiescent then. Create it with
+// container.groupBy(keyFn, aggregator); the view must not outlive the
+// container.
+template <typename Container, typename KeyFn, typename Aggregator,
+          typename Hash = std::hash<std::decay_t<std::invoke_result_t<KeyFn, const typename Container::value_type&>>>>
+class GroupByView
+    : public ViewObservers<std::pair<std::decay_t<std::invoke_result_t<KeyFn, const typename Container::value_type&>>,
+                                     typename Aggregator::State>> {
+public:
+    using element_type = typename Container::value_type;
+    using key_type = std::decay_t<std::invoke_result_t<KeyFn, const element_type&>>;
+    using aggregate_type = typename Aggregator::State;
+    using value_type = std::pair<key_type, aggregate_type>;
+
+    GroupByView(Container& source, KeyFn keyFn, Aggregator aggregator = Aggregator())
+        : source_(source), key_fn_(std::move(keyFn)), aggregator_(std::move(aggregator)) {
+        rebuildLocked();
+        handle_ = source_.addObserver([this](const ChangeEvent<element_type>& event) { onChange(event); });
+    }
+
+    ~GroupByView() {
+        source_.removeObserver(handle_);
+    }
+
+    // Number of groups.
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return groups_.size();
+    }
+
+    bool empty() const { return size() == 0; }
+
+    std::optional<aggregate_type> find(const key_type& key) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = groups_.find(key);
+        if (it == groups_.end()) {
+            return std::nullopt;
+        }
+        return it->second.aggregate;
+    }
+
+    // Number of elements in the group (0 if absent).
+    size_t memberCount(const key_type& key) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = groups_.find(key);
+        return it == groups_.end() ? 0 : it->second.members;
+    }
+
+    // All groups, in unspecified order.
+    std::vector<value_type> groups() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<value_type> out;
+        out.reserve(groups_.size());
+        for (const auto& [key, group] : groups_) {
+            out.emplace_back(key, group.aggregate);
+        }
+        return out;
+    }
+
+private:
+    using Events = std::vector<ChangeEvent<value_type>>;
+
+    struct Group {
+        size_t members = 0;
+        aggregate_type aggregate{};
+    };
+
+    // Group state before the current event, for at most two touched keys.
+    struct Touched {
+        key_type key;
+        std::optional<aggregate_type> before;
+    };
+
+    void onChange(const ChangeEvent<element_type>& event) {
+        Events events;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::vector<Touched> touched;
+            if (apply(event, touched)) {
+                publish(touched, events);
+            } else {
+                rebuildLocked();
+                events.emplace_back(ChangeType::BatchUpdate);
+            }
+        }
+        this->dispatch(events);
+    }
+
+    bool apply(const ChangeEvent<element_type>& event, std::vector<Touched>& touched) {
+        if (event.type == ChangeType::Permuted) {
+            return true; // Group membership does not depend on positions
+        }
+        if (event.count) {
+            return false;
+        }
+        switch (event.type) {
+            case ChangeType::ElementAdded:
+                if (!event.newValue) return false;
+                addElement(*event.newValue, touched);
+                ++size_;
+                return true;
+            case ChangeType::ElementRemoved:
+                if (!event.oldValue || !removeElement(*event.oldValue, touched)) return false;
+                --size_;
+                return true;
+            case ChangeType::ElementModified:
+                if (!event.oldValue || !event.newValue || !removeElement(*event.oldValue, touched)) return false;
+                addElement(*event.newValue, touched);
+                return true;
+            case ChangeType::SizeChanged:
+                return !event.newSize || *event.newSize == size_;
+            default:
+                return false;
+        }
+    }
+
+    void remember(const key_type& key, std::vector<Touched>& touched) const {
+        for (const Touched& t : touched) {
+            if (t.key == key) return;
+        }
+        auto it = groups_.find(key);
+        touched.push_back(Touched{key, it == groups_.end() ? std::nullopt : std::optional<aggregate_type>(it->second.aggregate)});
+    }
+
+    void addElement(const element_type& value, std::vector<Touched>& touched) {
+        key_type key = key_fn_(value);
+        remember(key, touched);
+        Group& group = groups_[std::move(key)];
+        ++group.members;
+        aggregator_.add(group.aggregate, value);
+    }
+
+    bool removeElement(const element_type& value, std::vector<Touched>& touched) {
+        const key_type key = key_fn_(value);
+        auto it = groups_.find(key);
+        if (it == groups_.end()) {
+            return false; // Out of step with the container
+        }
+        remember(key, touched);
+        if (--it->second.members == 0) {
+            groups_.erase(it);
+        } else {
+            aggregator_.remove(it->second.aggregate, value);
+        }
+        return true;
+    }
+
+    void publish(const std::vector<Touched>& touched, Events& events) const {
+        for (const Touched& t : touched) {
+            auto it = groups_.find(t.key);
+            if (it == groups_.end()) {
+                if (t.before) {
+                    events.emplace_back(ChangeType::ElementRemoved, std::nullopt, value_type(t.key, *t.before), std::nullopt);
+                }
+            } else if (!t.before) {
+                events.emplace_back(ChangeType::ElementAdded, std::nullopt, std::nullopt, value_type(t.key, it->second.aggregate));
+            } else {
+                events.emplace_back(ChangeType::ElementModified, std::nullopt, value_type(t.key, *t.before),
+                                    value_type(t.key, it->second.aggregate));
+            }
+        }
+    }
+
+    void rebuildLocked() {
+        groups_.clear();
+        size_ = 0;
+        for (auto it = source_.cbegin(); it != source_.cend(); ++it) {
+            key_type key = key_fn_(*it);
+            Group& group = groups_[std::move(key)];
+            ++group.members;
+            aggregator_.add(group.aggregate, *it);
+            ++size_;
+        }
+    }
+
+    Container& source_;
+    KeyFn key_fn_;
+    Aggregator aggregator_;
+    typename Container::ObserverHandle handle_ = 0;
+
+    mutable std::mutex mutex_; // Guards groups_ and size_
+    std::unordered_map<key_type, Group, Hash> groups_;
+    size_t size_ = 0; // Source size as seen through events
+};
+
+#endif // GROUP_BY_VIEW_H
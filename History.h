@@ -0,0 +1,348 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <cstddef>    // Required for size_t
+#include <deque>      // Required for std::deque
+#include <functional> // Required for std::function
+#include <memory>     // Required for std::shared_ptr
+#include <mutex>      // Required for std::mutex, std::lock_guard
+#include <optional>   // Required for std::optional
+#include <thread>     // Required for std::thread::id, std::this_thread
+#include <utility>    // Required for std::move
+#include <vector>     // Required for std::vector
+#include "ChangeEvent.h"
+
+// Undo/redo for editor-style clients, recorded from the container's events
+// instead of whole-container snapshots.
+//
+// Every ElementAdded / ElementRemoved / ElementModified / Permuted event is
+// kept with its old and new values, which is enough to apply it backwards
+// (undo) or forwards again (redo). Events are grouped into steps: all events
+// of one container call (see ChangeEvent::continues, e.g. the removals of
+// extract_range() or both halves of swap()) by default, or all events
+// between beginGroup() and endGroup(). A call that is a single
+// ElementModified on the same index as the previous one is coalesced into
+// it (first old value, last new value) until seal(), beginGroup(),
+// endGroup(), undo() or redo() is called, so a run of keystrokes in one
+// field is undone at once.
+//
+// The undo and redo stacks share a byte budget. Each operation is charged
+// its bookkeeping plus valueBytes() of the values it holds (sizeof(T) by
+// default; pass a function for types that own heap memory), and the oldest
+// steps are dropped when the budget is exceeded. A new edit clears the redo
+// stack.
+//
+// undo() and redo() apply a whole step through with_lock(), i.e. as one
+// atomic step whose ordinary per-element events reach every observer. The
+// history ignores those events itself. Steps replay positions, so they
+// assume that every change to the container since was seen by the history.
+// Events that cannot be inverted (BatchUpdate, clear(), ranged events
+// without values) clear the history and the rest of their call is ignored;
+// if a step no longer fits the container, the changes applied so far are
+// kept, the history is cleared and the exception is rethrown.
+template <typename Container>
+class History {
+public:
+    using value_type = typename Container::value_type;
+    using ValueBytes = std::function<size_t(const value_type&)>;
+
+    static_assert(Container::emits(ChangeType::ElementAdded) && Container::emits(ChangeType::ElementRemoved) &&
+                      Container::emits(ChangeType::ElementModified) && Container::emits(ChangeType::Permuted) &&
+                      Container::emits(ChangeType::SizeChanged),
+                  "History needs every element-level event type and SizeChanged (to see clear()) to be enabled");
+
+    static constexpr size_t DefaultMaxBytes = size_t(1) << 20;
+
+    explicit History(Container& source, size_t maxBytes = DefaultMaxBytes, ValueBytes valueBytes = ValueBytes())
+        : source_(source), max_bytes_(maxBytes), value_bytes_(std::move(valueBytes)) {
+        handle_ = source_.addObserver([this](const ChangeEvent<value_type>& event) { onChange(event); });
+    }
+
+    ~History() {
+        source_.removeObserver(handle_);
+    }
+
+    History(const History&) = delete;
+    History& operator=(const History&) = delete;
+
+    bool canUndo() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return !undo_.empty();
+    }
+
+    bool canRedo() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return !redo_.empty();
+    }
+
+    size_t undoDepth() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return undo_.size();
+    }
+
+    size_t redoDepth() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return redo_.size();
+    }
+
+    // Bytes charged to both stacks. Within the budget after every edit
+    // unless the newest step alone exceeds it.
+    size_t bytes() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return bytes_;
+    }
+
+    // Ends coalescing: the next edit starts a new operation.
+    void seal() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        coalescing_ = false;
+    }
+
+    // Edits until the matching endGroup() form one step. Groups nest; only
+    // the outermost pair delimits the step.
+    void beginGroup() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (group_depth_++ == 0) {
+            coalescing_ = false; // The group's first edit opens its own step
+        }
+    }
+
+    void endGroup() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (group_depth_ > 0 && --group_depth_ == 0) {
+            group_open_ = false;
+            coalescing_ = false;
+        }
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        clearLocked();
+    }
+
+    // Reverts the most recent step; false if there is none.
+    bool undo() {
+        return replay(undo_, redo_, [](auto& view, const Step& step) {
+            for (auto op = step.ops.rbegin(); op != step.ops.rend(); ++op) {
+                applyInverse(view, *op);
+            }
+        });
+    }
+
+    // Re-applies the most recently undone step; false if there is none.
+    bool redo() {
+        return replay(redo_, undo_, [](auto& view, const Step& step) {
+            for (const Op& op : step.ops) {
+                applyForward(view, op);
+            }
+        });
+    }
+
+private:
+    // One recorded event. `before` / `after` hold the element's value on
+    // either side of the change, as far as the event type has them.
+    struct Op {
+        ChangeType type;
+        size_t index;
+        std::optional<value_type> before;
+        std::optional<value_type> after;
+        std::shared_ptr<const std::vector<size_t>> permutation;
+    };
+
+    struct Step {
+        std::vector<Op> ops;
+        size_t bytes = 0;
+    };
+
+    using Stack = std::deque<Step>; // Oldest step at the front
+
+    void onChange(const ChangeEvent<value_type>& event) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (applying_ == std::this_thread::get_id()) {
+            return; // Our own undo()/redo()
+        }
+        const bool continuing = in_call_; // An earlier event of this call was seen
+        in_call_ = event.continues;
+        if (event.type == ChangeType::SizeChanged) {
+            if (!continuing) {
+                clearLocked(); // A size change on its own is clear()
+            }
+            return;
+        }
+        if (continuing && undo_.empty()) {
+            return; // The call's step was discarded (cleared or invalid)
+        }
+        std::optional<Op> op = toOp(event);
+        if (!op) {
+            clearLocked();
+            return;
+        }
+        record(std::move(*op), continuing, event.continues);
+    }
+
+    static std::optional<Op> toOp(const ChangeEvent<value_type>& event) {
+        if (!event.index) {
+            return std::nullopt;
+        }
+        const size_t index = *event.index;
+        switch (event.type) {
+            case ChangeType::ElementAdded:
+                if (event.count || !event.newValue) return std::nullopt;
+                return Op{event.type, index, std::nullopt, event.newValue, nullptr};
+            case ChangeType::ElementRemoved:
+                if (event.count || !event.oldValue) return std::nullopt;
+                return Op{event.type, index, event.oldValue, std::nullopt, nullptr};
+            case ChangeType::ElementModified:
+                if (!event.oldValue || !event.newValue) return std::nullopt;
+                return Op{event.type, index, event.oldValue, event.newValue, nullptr};
+            case ChangeType::Permuted:
+                if (!event.permutation) return std::nullopt;
+                return Op{event.type, index, std::nullopt, std::nullopt, event.permutation};
+            default:
+                return std::nullopt;
+        }
+    }
+
+    // `continuing`: an earlier event of the same call opened undo_.back().
+    // `continues`: more events of the call follow.
+    void record(Op&& op, bool continuing, bool continues) {
+        for (const Step& step : redo_) {
+            bytes_ -= step.bytes;
+        }
+        redo_.clear();
+        if (!continuing && !continues && coalescing_ && op.type == ChangeType::ElementModified && !undo_.empty()) {
+            Step& step = undo_.back();
+            Op& last = step.ops.back();
+            if (last.type == ChangeType::ElementModified && last.index == op.index) {
+                const size_t old_bytes = opBytes(last);
+                last.after = std::move(op.after);
+                charge(step, old_bytes, opBytes(last));
+                trim();
+                return;
+            }
+        }
+        if (!continuing && (group_depth_ == 0 || !group_open_)) {
+            undo_.emplace_back();
+            group_open_ = group_depth_ > 0;
+        }
+        Step& step = undo_.back();
+        step.ops.push_back(std::move(op));
+        charge(step, 0, opBytes(step.ops.back()));
+        // Outside a group, only a single-event call may absorb the next edit.
+        coalescing_ = group_depth_ > 0 || (!continuing && !continues);
+        trim();
+    }
+
+    void charge(Step& step, size_t released, size_t added) {
+        step.bytes = step.bytes - released + added;
+        bytes_ = bytes_ - released + added;
+    }
+
+    // Drops the oldest steps until the budget holds (the redo stack is
+    // empty while recording). The newest step is kept even if it alone
+    // exceeds the budget.
+    void trim() {
+        while (bytes_ > max_bytes_ && undo_.size() > 1) {
+            bytes_ -= undo_.front().bytes;
+            undo_.pop_front();
+        }
+    }
+
+    template <typename Apply>
+    bool replay(Stack& from, Stack& to, Apply apply) {
+        Step step;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (from.empty()) {
+                return false;
+            }
+            step = std::move(from.back());
+            from.pop_back();
+            bytes_ -= step.bytes;
+            group_open_ = false;
+            coalescing_ = false;
+            applying_ = std::this_thread::get_id();
+        }
+        try {
+            source_.with_lock([&](auto& view) { apply(view, step); });
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            applying_ = std::thread::id();
+            clearLocked();
+            throw;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        applying_ = std::thread::id();
+        bytes_ += step.bytes;
+        to.push_back(std::move(step));
+        return true;
+    }
+
+    template <typename View>
+    static void applyInverse(View& view, const Op& op) {
+        switch (op.type) {
+            case ChangeType::ElementAdded:    view.erase(op.index); break;
+            case ChangeType::ElementRemoved:  view.insert(op.index, *op.before); break;
+            case ChangeType::ElementModified: view.modify(op.index, *op.before); break;
+            case ChangeType::Permuted: {
+                const auto& order = *op.permutation;
+                std::vector<size_t> inverse(order.size());
+                for (size_t k = 0; k < order.size(); ++k) {
+                    inverse[order[k]] = k;
+                }
+                view.permute(op.index, std::move(inverse));
+                break;
+            }
+            default: break;
+        }
+    }
+
+    template <typename View>
+    static void applyForward(View& view, const Op& op) {
+        switch (op.type) {
+            case ChangeType::ElementAdded:    view.insert(op.index, *op.after); break;
+            case ChangeType::ElementRemoved:  view.erase(op.index); break;
+            case ChangeType::ElementModified: view.modify(op.index, *op.after); break;
+            case ChangeType::Permuted:        view.permute(op.index, *op.permutation); break;
+            default: break;
+        }
+    }
+
+    size_t opBytes(const Op& op) const {
+        size_t bytes = sizeof(Op);
+        for (const auto* value : {&op.before, &op.after}) {
+            if (*value) {
+                bytes += value_bytes_ ? value_bytes_(**value) : sizeof(value_type);
+            }
+        }
+        if (op.permutation) {
+            bytes += op.permutation->size() * sizeof(size_t);
+        }
+        return bytes;
+    }
+
+    void clearLocked() {
+        undo_.clear();
+        redo_.clear();
+        bytes_ = 0;
+        group_open_ = false;
+        coalescing_ = false;
+    }
+
+    Container& source_;
+    const size_t max_bytes_;
+    ValueBytes value_bytes_;
+    typename Container::ObserverHandle handle_ = 0;
+
+    mutable std::mutex mutex_; // Guards everything below
+    Stack undo_;
+    Stack redo_;
+    size_t bytes_ = 0;
+    size_t group_depth_ = 0;
+    bool group_open_ = false;      // undo_.back() is the step of the open group
+    bool coalescing_ = false;      // undo_.back().ops.back() may absorb the next edit
+    bool in_call_ = false;         // The last event seen has ChangeEvent::continues set
+    std::thread::id applying_;     // Thread running undo()/redo(), whose events are ignored
+};
+
+#endif // HISTORY_H
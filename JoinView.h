@@ -0,0 +1,328 @@
+#ifndef JOIN_VIEW_H
+#define JOIN_VIEW_H
+
+#include <algorithm>     // Required for std::find_if
+#include <cstddef>       // Required for size_t
+#include <functional>    // Required for std::hash
+#include <map>           // Required for std::map
+#include <mutex>         // Required for std::mutex, std::lock_guard
+#include <type_traits>   // Required for std::invoke_result_t, std::decay_t, std::void_t
+#include <unordered_map> // Required for std::unordered_map
+#include <utility>       // Required for std::pair, std::move
+#include <vector>        // Required for std::vector
+#include "ChangeEvent.h"
+#include "ViewObservers.h"
+
+// Equi-join of two containers: every (left, right) pair with
+// leftKey(left) == rightKey(right), maintained from both containers' events.
+//
+// Each side is indexed by key in a hash map of buckets, and each bucket
+// counts equal elements: in a hash map when the element type has std::hash,
+// otherwise in a std::map when it has operator< (e.g. std::pair), otherwise
+// in a list scanned with operator==. An event on one side updates its own
+// bucket in O(1) expected (O(log b) for ordered elements, O(b) for the
+// operator== fallback, b = distinct elements with that key) and looks up
+// the matching bucket on the other side, so its cost is that plus the number
+// of pairs it creates or removes. Elements are identified by value, so
+// equal elements are interchangeable.
+//
+// The view is an observable collection of std::pair<Left, Right>. It
+// publishes events without an index: ElementAdded / ElementRemoved per pair
+// that appears or disappears, and ElementModified per pair when an element
+// changes value but keeps its key. Container events without values
+// (BatchUpdate, ranged or move-only events, clear()) re-index that side and
+// publish one BatchUpdate; re-indexing reads the container through its
+// iterators, so structural writers must be quiescent then. Create it with
+// join(left, right, leftKey, rightKey); the view must not outlive either
+// container.
+namespace JoinViewDetail {
+    template <typename T, class Enable = void>
+    struct IsHashable : std::false_type {};
+
+    template <typename T>
+    struct IsHashable<T, std::void_t<decltype(std::hash<T>{}(std::declval<const T&>()))>> : std::true_type {};
+
+    template <typename T, class Enable = void>
+    struct IsLessComparable : std::false_type {};
+
+    template <typename T>
+    struct IsLessComparable<T, std::void_t<decltype(std::declval<const T&>() < std::declval<const T&>())>> : std::true_type {};
+} // namespace JoinViewDetail
+
+template <typename LeftContainer, typename RightContainer, typename LeftKeyFn, typename RightKeyFn>
+class JoinView
+    : public ViewObservers<std::pair<typename LeftContainer::value_type, typename RightContainer::value_type>> {
+public:
+    using left_type = typename LeftContainer::value_type;
+    using right_type = typename RightContainer::value_type;
+    using key_type = std::decay_t<std::invoke_result_t<LeftKeyFn, const left_type&>>;
+    using value_type = std::pair<left_type, right_type>;
+
+    static_assert(std::is_convertible_v<std::invoke_result_t<RightKeyFn, const right_type&>, key_type>,
+                  "Both key functions must produce the same key type");
+
+    JoinView(LeftContainer& left, RightContainer& right, LeftKeyFn leftKey, RightKeyFn rightKey)
+        : left_(left, std::move(leftKey)), right_(right, std::move(rightKey)) {
+        left_.rebuild();
+        right_.rebuild();
+        recount();
+        left_.handle = left.addObserver([this](const ChangeEvent<left_type>& event) {
+            onChange(event, left_, right_, [](const left_type& l, const right_type& r) { return value_type(l, r); });
+        });
+        right_.handle = right.addObserver([this](const ChangeEvent<right_type>& event) {
+            onChange(event, right_, left_, [](const right_type& r, const left_type& l) { return value_type(l, r); });
+        });
+    }
+
+    ~JoinView() {
+        left_.source.removeObserver(left_.handle);
+        right_.source.removeObserver(right_.handle);
+    }
+
+    // Number of matched pairs.
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return pair_count_;
+    }
+
+    bool empty() const { return size() == 0; }
+
+    // Matched pairs for one key.
+    std::vector<value_type> matches(const key_type& key) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<value_type> out;
+        appendMatches(key, out);
+        return out;
+    }
+
+    // All matched pairs, grouped by key in unspecified order.
+    std::vector<value_type> pairs() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<value_type> out;
+        out.reserve(pair_count_);
+        for (const auto& entry : left_.index) {
+            appendMatches(entry.first, out);
+        }
+        return out;
+    }
+
+private:
+    using Events = std::vector<ChangeEvent<value_type>>;
+
+    // One input: its container, key function, key -> values index and the
+    // element count seen through its events.
+    template <typename Source, typename KeyFn>
+    struct Side {
+        using element_type = typename Source::value_type;
+
+        static constexpr bool hashed = JoinViewDetail::IsHashable<element_type>::value;
+        static constexpr bool ordered = JoinViewDetail::IsLessComparable<element_type>::value;
+
+        // Distinct element -> multiplicity.
+        using Counts = std::conditional_t<hashed, std::unordered_map<element_type, size_t>,
+                       std::conditional_t<ordered, std::map<element_type, size_t>,
+                                          std::vector<std::pair<element_type, size_t>>>>;
+
+        // The elements with one key.
+        struct Bucket {
+            Counts counts;
+            size_t size = 0; // Sum of the multiplicities
+        };
+
+        Side(Source& s, KeyFn k) : source(s), key(std::move(k)) {}
+
+        void add(const element_type& value) {
+            Bucket& bucket = index[key(value)];
+            auto it = find(bucket.counts, value);
+            if (it == bucket.counts.end()) {
+                if constexpr (hashed || ordered) {
+                    it = bucket.counts.emplace(value, 0).first;
+                } else {
+                    it = bucket.counts.insert(bucket.counts.end(), {value, 0});
+                }
+            }
+            ++it->second;
+            ++bucket.size;
+        }
+
+        // Removes one element equal to `value`; false if there is none.
+        bool remove(const element_type& value) {
+            auto bucket = index.find(key(value));
+            if (bucket == index.end()) {
+                return false;
+            }
+            Counts& counts = bucket->second.counts;
+            auto it = find(counts, value);
+            if (it == counts.end()) {
+                return false;
+            }
+            if (--it->second == 0) {
+                if constexpr (hashed || ordered) {
+                    counts.erase(it);
+                } else {
+                    *it = std::move(counts.back());
+                    counts.pop_back();
+                }
+            }
+            if (--bucket->second.size == 0) {
+                index.erase(bucket);
+            }
+            return true;
+        }
+
+        static typename Counts::iterator find(Counts& counts, const element_type& value) {
+            if constexpr (hashed || ordered) {
+                return counts.find(value);
+            } else {
+                return std::find_if(counts.begin(), counts.end(), [&](const auto& entry) { return entry.first == value; });
+            }
+        }
+
+        const Bucket* bucket(const key_type& k) const {
+            auto it = index.find(k);
+            return it == index.end() ? nullptr : &it->second;
+        }
+
+        void rebuild() {
+            index.clear();
+            size = 0;
+            for (auto it = source.cbegin(); it != source.cend(); ++it) {
+                add(*it);
+                ++size;
+            }
+        }
+
+        Source& source;
+        KeyFn key;
+        typename Source::ObserverHandle handle = 0;
+        std::unordered_map<key_type, Bucket, std::hash<key_type>> index;
+        size_t size = 0;
+    };
+
+    using LeftSide = Side<LeftContainer, LeftKeyFn>;
+    using RightSide = Side<RightContainer, RightKeyFn>;
+
+    template <typename OwnSide, typename OtherSide, typename MakePair>
+    void onChange(const ChangeEvent<typename OwnSide::element_type>& event, OwnSide& own, OtherSide& other,
+                  MakePair makePair) {
+        Events events;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!apply(event, own, other, makePair, events)) {
+                own.rebuild();
+                recount();
+                events.clear();
+                events.emplace_back(ChangeType::BatchUpdate);
+            }
+        }
+        this->dispatch(events);
+    }
+
+    template <typename OwnSide, typename OtherSide, typename MakePair>
+    bool apply(const ChangeEvent<typename OwnSide::element_type>& event, OwnSide& own, const OtherSide& other,
+               MakePair& makePair, Events& events) {
+        if (event.type == ChangeType::Permuted) {
+            return true; // Matches do not depend on positions
+        }
+        if (event.count) {
+            return false;
+        }
+        switch (event.type) {
+            case ChangeType::ElementAdded: {
+                if (!event.newValue) return false;
+                own.add(*event.newValue);
+                ++own.size;
+                pair_count_ += forEachMatch(other, own.key(*event.newValue), [&](const auto& match) {
+                    events.emplace_back(ChangeType::ElementAdded, std::nullopt, std::nullopt, makePair(*event.newValue, match));
+                });
+                return true;
+            }
+            case ChangeType::ElementRemoved: {
+                if (!event.oldValue || !own.remove(*event.oldValue)) return false;
+                --own.size;
+                pair_count_ -= forEachMatch(other, own.key(*event.oldValue), [&](const auto& match) {
+                    events.emplace_back(ChangeType::ElementRemoved, std::nullopt, makePair(*event.oldValue, match), std::nullopt);
+                });
+                return true;
+            }
+            case ChangeType::ElementModified: {
+                if (!event.oldValue || !event.newValue || !own.remove(*event.oldValue)) return false;
+                own.add(*event.newValue);
+                const key_type old_key = own.key(*event.oldValue);
+                const key_type new_key = own.key(*event.newValue);
+                if (old_key == new_key) {
+                    forEachMatch(other, new_key, [&](const auto& match) {
+                        events.emplace_back(ChangeType::ElementModified, std::nullopt,
+                                            makePair(*event.oldValue, match), makePair(*event.newValue, match));
+                    });
+                } else {
+                    pair_count_ -= forEachMatch(other, old_key, [&](const auto& match) {
+                        events.emplace_back(ChangeType::ElementRemoved, std::nullopt, makePair(*event.oldValue, match), std::nullopt);
+                    });
+                    pair_count_ += forEachMatch(other, new_key, [&](const auto& match) {
+                        events.emplace_back(ChangeType::ElementAdded, std::nullopt, std::nullopt, makePair(*event.newValue, match));
+                    });
+                }
+                return true;
+            }
+            case ChangeType::SizeChanged:
+                return !event.newSize || *event.newSize == own.size;
+            default:
+                return false;
+        }
+    }
+
+    // Calls fn for each element of `other` with `key`; returns how many.
+    template <typename OtherSide, typename Fn>
+    size_t forEachMatch(const OtherSide& other, const key_type& key, Fn&& fn) const {
+        const auto* matches = other.bucket(key);
+        if (!matches) {
+            return 0;
+        }
+        for (const auto& [match, n] : matches->counts) {
+            for (size_t i = 0; i < n; ++i) {
+                fn(match);
+            }
+        }
+        return matches->size;
+    }
+
+    void appendMatches(const key_type& key, std::vector<value_type>& out) const {
+        const auto* lefts = left_.bucket(key);
+        const auto* rights = right_.bucket(key);
+        if (!lefts || !rights) {
+            return;
+        }
+        for (const auto& [l, left_n] : lefts->counts) {
+            for (const auto& [r, right_n] : rights->counts) {
+                for (size_t i = 0; i < left_n * right_n; ++i) {
+                    out.emplace_back(l, r);
+                }
+            }
+        }
+    }
+
+    void recount() {
+        pair_count_ = 0;
+        for (const auto& entry : left_.index) {
+            if (const auto* rights = right_.bucket(entry.first)) {
+                pair_count_ += entry.second.size * rights->size;
+            }
+        }
+    }
+
+    mutable std::mutex mutex_; // Guards both sides and pair_count_
+    LeftSide left_;
+    RightSide right_;
+    size_t pair_count_ = 0;
+};
+
+// Joins `left` and `right` on leftKey(l) == rightKey(r). Requires that both
+// outlive the returned view.
+template <typename LeftContainer, typename RightContainer, typename LeftKeyFn, typename RightKeyFn>
+JoinView<LeftContainer, RightContainer, LeftKeyFn, RightKeyFn>
+join(LeftContainer& left, RightContainer& right, LeftKeyFn leftKey, RightKeyFn rightKey) {
+    return JoinView<LeftContainer, RightContainer, LeftKeyFn, RightKeyFn>(left, right, std::move(leftKey), std::move(rightKey));
+}
+
+#endif // JOIN_VIEW_H
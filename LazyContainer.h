@@ -0,0 +1,143 @@
+#ifndef LAZY_CONTAINER_H
+#define LAZY_CONTAINER_H
+
+#include <cstddef>    // Required for size_t
+#include <functional> // Required for std::function
+#include <limits>     // Required for std::numeric_limits
+#include <mutex>      // Required for std::mutex, std::lock_guard
+#include <stdexcept>  // Required for std::invalid_argument, std::out_of_range
+#include <utility>    // Required for std::move, std::forward
+#include <vector>     // Required for std::vector
+#include "ChangeEvent.h"
+
+// An ObservableContainer filled on demand from an expensive source (a
+// parser, a query cursor) instead of being materialized upfront.
+//
+// The loader is called as loader(offset, maxCount, out): it appends up to
+// maxCount elements, starting at position `offset` of the source, to `out`
+// and returns how many it appended; 0 means the source is exhausted.
+// Elements are requested in chunks of `chunkSize` only when an accessor
+// needs a position past the materialized prefix, so the cost of startup is
+// proportional to what consumers actually read.
+//
+// Each chunk is appended with append_range(), i.e. observers of container()
+// see one ElementAdded per element, with its value, plus SizeChanged, all
+// marked as one call, so views and History update incrementally instead of
+// rebuilding per chunk. Observers run on the thread that triggered the
+// load, while the load lock is held: they may read container() but must not
+// call back into the materializing methods of this object.
+//
+// Writers may modify container() directly; the accessors below index the
+// container as it is, and the loader keeps reading the source from where it
+// left off.
+template <typename Container>
+class LazyContainer {
+public:
+    using value_type = typename Container::value_type;
+    using Loader = std::function<size_t(size_t offset, size_t maxCount, std::vector<value_type>& out)>;
+
+    static constexpr size_t DefaultChunkSize = 4096;
+
+    template <typename... Args>
+    explicit LazyContainer(Loader loader, size_t chunkSize = DefaultChunkSize, Args&&... args)
+        : loader_(std::move(loader)), chunk_size_(chunkSize), container_(std::forward<Args>(args)...) {
+        if (!loader_) {
+            throw std::invalid_argument("LazyContainer requires a loader");
+        }
+        if (chunk_size_ == 0) {
+            throw std::invalid_argument("LazyContainer chunk size must be positive");
+        }
+    }
+
+    LazyContainer(const LazyContainer&) = delete;
+    LazyContainer& operator=(const LazyContainer&) = delete;
+
+    // The backing container, holding the materialized prefix. Attach views
+    // and observers here.
+    Container& container() noexcept { return container_; }
+    const Container& container() const noexcept { return container_; }
+
+    size_t chunkSize() const noexcept { return chunk_size_; }
+
+    // Number of elements taken from the loader so far.
+    size_t materialized() const {
+        std::lock_guard<std::mutex> lock(load_mutex_);
+        return produced_;
+    }
+
+    bool exhausted() const {
+        std::lock_guard<std::mutex> lock(load_mutex_);
+        return exhausted_;
+    }
+
+    // Loads chunks until the container holds at least `count` elements or
+    // the source is exhausted; returns whether it holds `count`.
+    bool ensure(size_t count) {
+        std::lock_guard<std::mutex> lock(load_mutex_);
+        while (container_.size() < count && loadChunkLocked()) {
+        }
+        return container_.size() >= count;
+    }
+
+    // Drains the source; returns the container size.
+    size_t materializeAll() {
+        std::lock_guard<std::mutex> lock(load_mutex_);
+        while (loadChunkLocked()) {
+        }
+        return container_.size();
+    }
+
+    // Element `index`, loading up to it first. Throws std::out_of_range if
+    // the source ends before `index`.
+    value_type at(size_t index) {
+        if (!ensure(index + 1)) {
+            throw std::out_of_range("LazyContainer index past the end of the source");
+        }
+        return container_.at(index);
+    }
+
+    // Paged read (see ObservableContainer::read_page) that loads the page
+    // first; a page past the end of the source is returned short.
+    size_t read_page(size_t offset, size_t count, std::vector<value_type>& out) {
+        ensure(count > std::numeric_limits<size_t>::max() - offset ? std::numeric_limits<size_t>::max()
+                                                                    : offset + count);
+        return container_.read_page(offset, count, out);
+    }
+
+    // Calls fn(const value_type&) for [first, last), loading up to `last`.
+    // Throws std::out_of_range if the source ends before `last`.
+    template <typename Fn>
+    void visit_range(size_t first, size_t last, Fn&& fn) {
+        ensure(last);
+        container_.visit_range(first, last, std::forward<Fn>(fn));
+    }
+
+private:
+    // Appends one chunk from the loader; false once the source is exhausted.
+    bool loadChunkLocked() {
+        if (exhausted_) {
+            return false;
+        }
+        chunk_.clear();
+        chunk_.reserve(chunk_size_);
+        const size_t n = loader_(produced_, chunk_size_, chunk_);
+        if (n == 0 || chunk_.empty()) {
+            exhausted_ = true;
+            return false;
+        }
+        produced_ += chunk_.size();
+        container_.append_range(std::move(chunk_));
+        return true;
+    }
+
+    Loader loader_;
+    const size_t chunk_size_;
+    Container container_;
+
+    mutable std::mutex load_mutex_; // Serializes loader calls; guards produced_, exhausted_, chunk_
+    size_t produced_ = 0;
+    bool exhausted_ = false;
+    std::vector<value_type> chunk_; // Reused chunk buffer
+};
+
+#endif // LAZY_CONTAINER_H
@@ -0,0 +1,68 @@
+#ifndef LOCKING_POLICY_H
+#define LOCKING_POLICY_H
+
+#include <mutex>        // Required for std::mutex, std::lock_guard
+#include <shared_mutex> // Required for std::shared_mutex, std::shared_lock
+#include <array>        // Required for std::array (stripe table)
+#include <cstddef>      // Required for size_t
+
+// Locking policies for ObservableContainer.
+//
+// A policy provides:
+//   - mutex_type:  the structural mutex guarding data_ and the observer list.
+//                  Size-changing operations always hold it exclusively.
+//   - SharedLock:  the guard used by read-only / observer-snapshot paths.
+//   - ElementLock: the guard used by size-preserving per-element operations
+//                  (modify, at). Constructed from (structural mutex, policy, index).
+
+// Default policy: one global mutex, every operation is serialized.
+struct GlobalLocking {
+    using mutex_type = std::mutex;
+    using SharedLock = std::lock_guard<std::mutex>;
+
+    class ElementLock {
+    public:
+        ElementLock(mutex_type& structural, GlobalLocking&, size_t)
+            : lock_(structural) {}
+
+    private:
+        std::lock_guard<mutex_type> lock_;
+    };
+};
+
+// Striped policy: size-preserving updates take the structural mutex in shared
+// mode plus one of `Stripes` element mutexes chosen by index. Concurrent
+// modify() calls on elements that hash to different stripes do not contend;
+// push_back/erase/etc. still take the structural mutex exclusively and thus
+// wait for all in-flight element operations.
+template <size_t Stripes = 64>
+struct StripedLocking {
+    static_assert(Stripes > 0, "StripedLocking requires at least one stripe");
+
+    using mutex_type = std::shared_mutex;
+    using SharedLock = std::shared_lock<std::shared_mutex>;
+
+    class ElementLock {
+    public:
+        ElementLock(mutex_type& structural, StripedLocking& policy, size_t index)
+            : structural_(structural), stripe_(policy.stripeFor(index)) {}
+
+    private:
+        std::shared_lock<mutex_type> structural_; // Acquired first, released last
+        std::lock_guard<std::mutex> stripe_;
+    };
+
+    std::mutex& stripeFor(size_t index) {
+        return stripes_[index % Stripes].mutex;
+    }
+
+private:
+    // Each stripe sits on its own cache line to avoid false sharing between
+    // threads hammering neighbouring stripes.
+    struct alignas(64) Stripe {
+        std::mutex mutex;
+    };
+    std::array<Stripe, Stripes> stripes_;
+};
+
+#endif // LOCKING_POLICY_H
@@ -11,18 +11,65 @@
 #include <optional>  // Already in ChangeEvent.h, but good for explicitness
 #include <iterator>  // Required for std::advance, std::distance
 #include <stdexcept> // Required for std::out_of_range
+#include <atomic>    // Required for std::atomic (batch flag shared across element locks)
+#include <type_traits> // Required for std::is_copy_constructible_v
+#include <cstring>   // Required for std::memcpy (read_page)
+#include <memory>    // Required for std::make_shared (Permuted events)
+#include <numeric>   // Required for std::iota
 #include "ChangeEvent.h"
+#include "LockingPolicy.h"
+#include "AccessPolicy.h"
+#include "ParallelKernels.h"
 
 // Forward declaration
 template <
     typename T,
     template <typename, typename> class ActualContainer, 
-    typename Allocator
+    typename Allocator,
+    typename LockPolicy,
+    typename AccessPolicy,
+    ChangeTypeMask EnabledEvents
 >
 class ObservableContainer;
 
+// Derived views built by the member functions below; include the matching
+// header (e.g. TopKView.h) to use one.
+template <typename Container, typename Compare>
+class TopKView;
+template <typename Container, typename Compare>
+class SortedView;
+template <typename Container, typename KeyFn, typename Aggregator, typename Hash>
+class GroupByView;
+struct CountAggregator;
+
+// Tag selecting ObservableContainer's bulk-load constructor, after C++23's
+// std::from_range: ObservableContainer<int> c(from_range, values).
+struct from_range_t {
+    explicit from_range_t() = default;
+};
+inline constexpr from_range_t from_range{};
+
 // Helper for container access to abstract away operator[] vs std::advance
 namespace ObservableContainerHelpers {
+    template <typename ContainerType>
+    struct IsStdList : std::false_type {};
+
+    template <typename ValueType, typename Alloc>
+    struct IsStdList<std::list<ValueType, Alloc>> : std::true_type {};
+
+    template <typename ContainerType>
+    struct IsStdVector : std::false_type {};
+
+    template <typename ValueType, typename Alloc>
+    struct IsStdVector<std::vector<ValueType, Alloc>> : std::true_type {};
+
+    template <typename ValueType, class Enable = void>
+    struct IsEqualityComparable : std::false_type {};
+
+    template <typename ValueType>
+    struct IsEqualityComparable<ValueType,
+        std::void_t<decltype(std::declval<const ValueType&>() == std::declval<const ValueType&>())>> : std::true_type {};
+
     template <typename ContainerType, typename ValueType, class Enable = void>
     struct ContainerAccess;
 
@@ -35,6 +82,12 @@ namespace ObservableContainerHelpers {
             std::is_same<decltype(std::declval<const ContainerType>()[0]), const ValueType&>::value
         >::type
     > {
+        static ValueType& get_unchecked(ContainerType& c, size_t index) {
+            return c[index];
+        }
+        static const ValueType& get_unchecked(const ContainerType& c, size_t index) {
+            return c[index];
+        }
         static ValueType& get(ContainerType& c, size_t index) {
             if (index >= c.size()) throw std::out_of_range("Index out of range");
             return c[index];
@@ -56,6 +109,16 @@ namespace ObservableContainerHelpers {
     // Specialization for std::list
     template <typename ValueType, typename Alloc>
     struct ContainerAccess<std::list<ValueType, Alloc>, ValueType> {
+        static ValueType& get_unchecked(std::list<ValueType, Alloc>& c, size_t index) {
+            auto it = c.begin();
+            std::advance(it, index);
+            return *it;
+        }
+        static const ValueType& get_unchecked(const std::list<ValueType, Alloc>& c, size_t index) {
+            auto it = c.cbegin();
+            std::advance(it, index);
+            return *it;
+        }
         static ValueType& get(std::list<ValueType, Alloc>& c, size_t index) {
             if (index >= c.size()) throw std::out_of_range("Index out of range for list access");
             auto it = c.begin();
@@ -86,73 +149,535 @@ namespace ObservableContainerHelpers {
 template <
     typename T,
     template <typename, typename> class ActualContainer = std::vector, // Default here
-    typename Allocator = std::allocator<T>
+    typename Allocator = std::allocator<T>,
+    typename LockPolicy = GlobalLocking, // See LockingPolicy.h; StripedLocking<N> for modify-heavy workloads
+    typename AccessPolicy = CheckedAccess, // See AccessPolicy.h; DebugAssertAccess / UncheckedAccess
+    ChangeTypeMask EnabledEvents = AllChangeTypes // Event types to generate; others are compiled out
 >
 class ObservableContainer {
 public: // Public type aliases
+    using value_type = T;
     using ObserverCallback = std::function<void(const ChangeEvent<T>&)>;
+    // Subscription filter evaluated in the dispatch loop, before the callback.
+    using ObserverPredicate = std::function<bool(const ChangeEvent<T>&)>;
     using ObserverHandle = uint64_t;
 
+    // Whether events of `type` are generated at all. Disabled types are removed
+    // at compile time, including the capture of their old/new values. Changes
+    // made inside a beginUpdate()/endUpdate() batch still produce BatchUpdate
+    // as long as that type is enabled.
+    static constexpr bool emits(ChangeType type) noexcept {
+        return (EnabledEvents & changeTypeBit(type)) != 0;
+    }
+
 private:
+    using Access = ObservableContainerHelpers::ContainerAccess<ActualContainer<T, Allocator>, T>;
+
     ActualContainer<T, Allocator> data_; // Use the templated container type
-    std::list<std::pair<ObserverHandle, ObserverCallback>> observers_;
+    struct ObserverEntry {
+        ObserverHandle handle;
+        ObserverCallback callback;
+        ObserverPredicate predicate; // Empty: deliver every event
+    };
+    std::list<ObserverEntry> observers_;
+    using mutex_type = typename LockPolicy::mutex_type;
+    using SharedLock = typename LockPolicy::SharedLock;
+    using ElementLock = typename LockPolicy::ElementLock;
+
     int defer_level_ = 0;
-    bool batch_changed_ = false;
-    mutable std::mutex mutex_; // Mutex for thread safety
+    // Atomic because, under StripedLocking, notify() for concurrent modify()
+    // calls only holds the structural mutex in shared mode.
+    std::atomic<bool> batch_changed_{false};
+    // Advanced by every observed mutation; atomic for the same reason.
+    std::atomic<uint64_t> version_{0};
+    mutable mutex_type mutex_; // Structural mutex for thread safety
+    mutable LockPolicy lock_policy_; // Per-element lock state (stripes), if any
     inline static ObserverHandle nextHandleId_ = 0; 
     bool is_moved_from_ = false;
 
     void notify(ChangeType type,
                 std::optional<size_t> index = std::nullopt,
                 std::optional<T> oldValue = std::nullopt,
-                std::optional<T> newValue = std::nullopt) {
+                std::optional<T> newValue = std::nullopt,
+                bool continues = false) {
+        // Values are moved into the event: observers see the removed/replaced
+        // element by reference without another copy (and move-only T works).
+        ChangeEvent<T> event{type, index, std::move(oldValue), std::move(newValue)};
+        event.continues = continues;
+        notify(event);
+    }
+
+    // Dispatches a caller-owned event. Observers receive it by const reference,
+    // so the caller may move values back out of it afterwards (see take()).
+    void notify(ChangeEvent<T>& event) {
         if (is_moved_from_) {
             return; // Moved-from object should not send notifications
         }
-        std::list<ObserverCallback> observers_to_call_functions;
+        if ((EnabledEvents & changeTypeBit(event.type)) == 0) {
+            return; // Call sites compile disabled types out; this is a backstop
+        }
+        std::vector<std::pair<ObserverCallback, ObserverPredicate>> observers_to_call_functions;
         bool should_call_observers = false;
 
         {
-            std::lock_guard<std::mutex> lock(mutex_);
-            if (type != ChangeType::BatchUpdate && defer_level_ > 0) {
+            SharedLock lock(mutex_);
+            if (event.type != ChangeType::BatchUpdate && defer_level_ > 0) {
                 batch_changed_ = true;
             } else {
-                for (const auto& pair : observers_) {
-                    observers_to_call_functions.push_back(pair.second);
+                observers_to_call_functions.reserve(observers_.size());
+                for (const auto& entry : observers_) {
+                    observers_to_call_functions.emplace_back(entry.callback, entry.predicate);
                 }
                 should_call_observers = true;
             }
         }
 
         if (should_call_observers && !observers_to_call_functions.empty()) {
-            ChangeEvent<T> event{type, index, oldValue, newValue};
-            if (type == ChangeType::SizeChanged) {
+            if (event.type == ChangeType::SizeChanged) {
                 // For SizeChanged events, populate the newSize field.
                 // This requires re-acquiring the mutex to safely access data_.size().
                 // This is a pragmatic choice to limit the scope of changes for this enhancement,
                 // avoiding modification of all notify call sites.
-                std::lock_guard<std::mutex> lock(mutex_);
+                SharedLock lock(mutex_);
                 event.newSize = data_.size();
             }
-            for (const auto& observer_func : observers_to_call_functions) {
-                if (observer_func) {
+            for (const auto& [observer_func, predicate] : observers_to_call_functions) {
+                // Content-based subscriptions: the predicate runs before the
+                // callback, so selective observers (and any queue behind them,
+                // e.g. compactObserver()) only see matching events.
+                if (observer_func && (!predicate || predicate(event))) {
+                    observer_func(event);
+                }
+            }
+        }
+    }
+
+    // Dispatches the events of one call, recorded under the lock (with_lock(),
+    // range operations), with a single observer snapshot. Every event but the
+    // last is marked as continued. Deferred like notify() inside beginUpdate().
+    void notify_recorded(std::vector<ChangeEvent<T>>& events) {
+        if (is_moved_from_ || events.empty()) {
+            return;
+        }
+        for (size_t k = 0; k + 1 < events.size(); ++k) {
+            events[k].continues = true;
+        }
+        std::vector<std::pair<ObserverCallback, ObserverPredicate>> observers_to_call_functions;
+        {
+            SharedLock lock(mutex_);
+            if (defer_level_ > 0) {
+                batch_changed_ = true;
+                return;
+            }
+            observers_to_call_functions.reserve(observers_.size());
+            for (const auto& entry : observers_) {
+                observers_to_call_functions.emplace_back(entry.callback, entry.predicate);
+            }
+            if (events.back().type == ChangeType::SizeChanged) {
+                events.back().newSize = data_.size();
+            }
+        }
+        for (const ChangeEvent<T>& event : events) {
+            for (const auto& [observer_func, predicate] : observers_to_call_functions) {
+                if (observer_func && (!predicate || predicate(event))) {
                     observer_func(event);
                 }
             }
         }
     }
 
+    template <typename U, template <typename, typename> class C, typename A, typename L, typename P, ChangeTypeMask M>
+    friend void transfer(ObservableContainer<U, C, A, L, P, M>& src, size_t first, size_t last,
+                         ObservableContainer<U, C, A, L, P, M>& dst, size_t pos);
+
+    // Records a change made under mutex_: advances version_ and marks the
+    // enclosing batch as changed when none of `Types` is emitted (an emitted
+    // event would do so in notify()).
+    template <ChangeType... Types>
+    void note_change_locked() {
+        version_.fetch_add(1, std::memory_order_release);
+        if constexpr (emits(ChangeType::BatchUpdate) && !(emits(Types) || ...)) {
+            if (defer_level_ > 0) {
+                batch_changed_ = true;
+            }
+        }
+    }
+
+    void notify_size_changed() {
+        if constexpr (emits(ChangeType::SizeChanged)) {
+            notify(ChangeType::SizeChanged);
+        }
+    }
+
+    // Events for `n` elements added at `index` (or removed from it) by one
+    // call, with `values` pointing at those elements. Copyable T gets one
+    // event per element with a copy of its value, ElementAdded at index + k
+    // and ElementRemoved at `index` (the order a mirror applies them), so
+    // observers update incrementally. Move-only T, or a container nobody
+    // observes, gets a single ranged event (count = n, no values). Followed
+    // by SizeChanged if emitted. Caller holds mutex_.
+    template <typename Iterator>
+    std::vector<ChangeEvent<T>> range_events_locked(ChangeType type, size_t index, size_t n, Iterator values) const {
+        std::vector<ChangeEvent<T>> events;
+        if (emits(type)) {
+            if constexpr (std::is_copy_constructible_v<T>) {
+                if (!observers_.empty()) {
+                    events.reserve(n + 1);
+                    for (size_t k = 0; k < n; ++k, ++values) {
+                        if (type == ChangeType::ElementAdded) {
+                            events.emplace_back(type, index + k, std::nullopt, *values);
+                        } else {
+                            events.emplace_back(type, index, *values);
+                        }
+                    }
+                }
+            }
+            if (events.empty()) {
+                events.emplace_back(type, index);
+                events.back().count = n;
+            }
+        }
+        if constexpr (emits(ChangeType::SizeChanged)) {
+            events.emplace_back(ChangeType::SizeChanged);
+        }
+        return events;
+    }
+
+    // Moves the element at `index` into `event.oldValue` and erases its slot.
+    // Caller must hold mutex_ exclusively and have checked the bound.
+    void take_locked(size_t index, ChangeEvent<T>& event) {
+        auto it = data_.begin();
+        std::advance(it, index);
+        event.oldValue.emplace(std::move(*it));
+        data_.erase(it);
+    }
+
+    // read_page() copies with memcpy when elements are contiguous and trivially copyable.
+    static constexpr bool page_is_memcpy =
+        std::is_trivially_copyable_v<T> && !std::is_same_v<T, bool> &&
+        ObservableContainerHelpers::IsStdVector<ActualContainer<T, Allocator>>::value;
+
+    // Caller must hold mutex_.
+    size_t page_length_locked(size_t offset, size_t count) const {
+        const size_t size = data_.size();
+        return offset >= size ? 0 : std::min(count, size - offset);
+    }
+
+    void copy_page_locked(size_t offset, size_t n, T* out) const {
+        if (n == 0) {
+            return;
+        }
+        if constexpr (page_is_memcpy) {
+            std::memcpy(static_cast<void*>(out), data_.data() + offset, n * sizeof(T));
+        } else {
+            auto it = data_.cbegin();
+            std::advance(it, offset);
+            std::copy_n(it, n, out);
+        }
+    }
+
+    // Records a permutation already applied to data_ at `first` and returns
+    // its event (if Permuted is emitted). Caller holds mutex_ exclusively.
+    std::optional<ChangeEvent<T>> note_permuted_locked(size_t first, std::vector<size_t>&& order) {
+        note_change_locked<ChangeType::Permuted>();
+        if constexpr (emits(ChangeType::Permuted)) {
+            ChangeEvent<T> event{ChangeType::Permuted, first};
+            event.count = order.size();
+            event.permutation = std::make_shared<const std::vector<size_t>>(std::move(order));
+            return event;
+        } else {
+            return std::nullopt;
+        }
+    }
+
+    // Applies `order` at `first` after trimming the positions that stay in
+    // place at both ends. Caller holds mutex_ exclusively.
+    std::optional<ChangeEvent<T>> reorder_locked(size_t first, std::vector<size_t> order) {
+        size_t lo = 0;
+        size_t hi = order.size();
+        while (lo < hi && order[lo] == lo) {
+            ++lo;
+        }
+        while (hi > lo && order[hi - 1] == hi - 1) {
+            --hi;
+        }
+        if (lo == hi) {
+            return std::nullopt; // Identity
+        }
+        std::vector<size_t> moved(hi - lo);
+        for (size_t k = lo; k < hi; ++k) {
+            moved[k - lo] = order[k] - lo; // A permutation of [lo, hi) once trimmed
+        }
+        first += lo;
+
+        auto range_begin = std::next(data_.begin(), first);
+        if constexpr (ObservableContainerHelpers::IsStdList<ActualContainer<T, Allocator>>::value) {
+            std::vector<typename ActualContainer<T, Allocator>::iterator> nodes;
+            nodes.reserve(moved.size());
+            for (size_t k = 0; k < moved.size(); ++k, ++range_begin) {
+                nodes.push_back(range_begin);
+            }
+            // Relinks each node, in the new order, in front of the range end.
+            for (size_t source : moved) {
+                data_.splice(range_begin, data_, nodes[source]);
+            }
+        } else {
+            std::vector<T> staged;
+            staged.reserve(moved.size());
+            for (size_t source : moved) {
+                staged.push_back(std::move(range_begin[source]));
+            }
+            std::move(staged.begin(), staged.end(), range_begin);
+        }
+        return note_permuted_locked(first, std::move(moved));
+    }
+
+    // Throws unless `order` is a permutation of [0, order.size()) that fits
+    // at `first`.
+    void require_permutation_locked(size_t first, const std::vector<size_t>& order) const {
+        if (first > data_.size() || order.size() > data_.size() - first) {
+            throw std::out_of_range("permute() range out of range");
+        }
+        std::vector<bool> seen(order.size(), false);
+        for (size_t source : order) {
+            if (source >= order.size() || seen[source]) {
+                throw std::invalid_argument("permute() order is not a permutation");
+            }
+            seen[source] = true;
+        }
+    }
+
+    void notify_permuted(std::optional<ChangeEvent<T>>& event) {
+        if (event) {
+            notify(*event);
+        }
+    }
+
+    // Stable sort of an index permutation: std::stable_sort, or per-chunk
+    // stable sorts followed by rounds of pairwise std::inplace_merge.
+    template <typename IndexCompare>
+    static void sort_order(std::vector<size_t>& order, IndexCompare compare, ExecutionPolicy policy) {
+        ThreadPool& pool = ThreadPool::shared();
+        const size_t n = order.size();
+        if (!ParallelKernels::goParallel(policy, n, pool)) {
+            std::stable_sort(order.begin(), order.end(), compare);
+            return;
+        }
+        const size_t chunks = ParallelKernels::chunkCount(n, pool);
+        const size_t run = (n + chunks - 1) / chunks; // Chunk size used by forEachChunk
+        ParallelKernels::forEachChunk(pool, n, chunks, [&](size_t, size_t begin, size_t end) {
+            std::stable_sort(order.begin() + static_cast<std::ptrdiff_t>(begin),
+                             order.begin() + static_cast<std::ptrdiff_t>(end), compare);
+        });
+        for (size_t width = run; width < n; width *= 2) {
+            const size_t pairs = (n + 2 * width - 1) / (2 * width);
+            ParallelKernels::forEachChunk(pool, pairs, pairs, [&](size_t pair, size_t, size_t) {
+                const size_t lo = pair * 2 * width;
+                const size_t mid = std::min(lo + width, n);
+                const size_t hi = std::min(lo + 2 * width, n);
+                if (mid < hi) {
+                    std::inplace_merge(order.begin() + static_cast<std::ptrdiff_t>(lo),
+                                       order.begin() + static_cast<std::ptrdiff_t>(mid),
+                                       order.begin() + static_cast<std::ptrdiff_t>(hi), compare);
+                }
+            });
+        }
+    }
+
+    // Bulk copies for the copy operations and from_range. Containers of at
+    // least ParallelKernels::ParallelThreshold elements with random access
+    // are sized first and then filled by chunks on ThreadPool::shared(),
+    // each chunk by one thread: a memcpy for trivially copyable T in a
+    // std::vector, element-wise assignment otherwise. Sizing value-initializes
+    // the elements on the calling thread (std::vector offers no uninitialized
+    // resize), so pages are first touched there, not by the copying threads.
+    // Smaller, list-based or non-default-constructible data is copied serially.
+    static constexpr bool chunked_copy_supported =
+        std::is_default_constructible_v<T> && std::is_copy_assignable_v<T> && !std::is_same_v<T, bool> &&
+        std::is_base_of_v<std::random_access_iterator_tag,
+                          typename std::iterator_traits<typename ActualContainer<T, Allocator>::iterator>::iterator_category>;
+
+    // Iterators known to address contiguous T storage.
+    template <typename It>
+    static constexpr bool contiguous_iterator =
+        std::is_same_v<It, T*> || std::is_same_v<It, const T*> ||
+        std::is_same_v<It, typename std::vector<T>::iterator> || std::is_same_v<It, typename std::vector<T>::const_iterator> ||
+        std::is_same_v<It, typename std::vector<T, Allocator>::iterator> ||
+        std::is_same_v<It, typename std::vector<T, Allocator>::const_iterator>;
+
+    template <typename SourceIterator>
+    static void copy_chunked(ActualContainer<T, Allocator>& dst, SourceIterator first, size_t n) {
+        ThreadPool& pool = ThreadPool::shared();
+        if constexpr (chunked_copy_supported) {
+            if (ParallelKernels::goParallel(ExecutionPolicy::Auto, n, pool)) {
+                dst.clear();
+                dst.resize(n);
+                ParallelKernels::forEachChunk(pool, n, ParallelKernels::chunkCount(n, pool), [&](size_t, size_t begin, size_t end) {
+                    if constexpr (page_is_memcpy && contiguous_iterator<SourceIterator>) {
+                        std::memcpy(static_cast<void*>(dst.data() + begin), &*(first + begin), (end - begin) * sizeof(T));
+                    } else {
+                        std::copy(first + begin, first + end, dst.begin() + static_cast<std::ptrdiff_t>(begin));
+                    }
+                });
+                return;
+            }
+        }
+        dst.assign(first, first + n);
+    }
+
+    static void copy_data(ActualContainer<T, Allocator>& dst, const ActualContainer<T, Allocator>& src) {
+        if constexpr (chunked_copy_supported) {
+            copy_chunked(dst, src.begin(), src.size());
+        } else {
+            dst = src;
+        }
+    }
+
+    // Element-wise equality, compared in parallel chunks for large
+    // random-access containers (copy assignment skips equal data).
+    static bool equal_data(const ActualContainer<T, Allocator>& a, const ActualContainer<T, Allocator>& b) {
+        if (a.size() != b.size()) {
+            return false;
+        }
+        if constexpr (chunked_copy_supported) {
+            ThreadPool& pool = ThreadPool::shared();
+            const size_t n = a.size();
+            if (ParallelKernels::goParallel(ExecutionPolicy::Auto, n, pool)) {
+                std::atomic<bool> equal{true};
+                ParallelKernels::forEachChunk(pool, n, ParallelKernels::chunkCount(n, pool), [&](size_t, size_t begin, size_t end) {
+                    if (equal.load(std::memory_order_relaxed) &&
+                        !std::equal(a.begin() + static_cast<std::ptrdiff_t>(begin), a.begin() + static_cast<std::ptrdiff_t>(end),
+                                    b.begin() + static_cast<std::ptrdiff_t>(begin))) {
+                        equal.store(false, std::memory_order_relaxed);
+                    }
+                });
+                return equal.load();
+            }
+        }
+        return a == b;
+    }
+
+    // Runs `kernel(first, n, policy)` on a random-access range (a raw pointer
+    // for std::vector) or `scan()` on std::list. Caller holds mutex_.
+    template <typename Kernel, typename Scan>
+    auto search_locked(ExecutionPolicy policy, Kernel&& kernel, Scan&& scan) const {
+        using Iterator = typename ActualContainer<T, Allocator>::const_iterator;
+        if constexpr (ObservableContainerHelpers::IsStdVector<ActualContainer<T, Allocator>>::value && !std::is_same_v<T, bool>) {
+            return kernel(data_.data(), data_.size(), policy);
+        } else if constexpr (std::is_base_of_v<std::random_access_iterator_tag,
+                                               typename std::iterator_traits<Iterator>::iterator_category>) {
+            return kernel(data_.cbegin(), data_.size(), policy);
+        } else {
+            return scan();
+        }
+    }
+
+    // Caller holds mutex_, so version_ is stable.
+    SearchResult indexResult(size_t index) const {
+        SearchResult result;
+        if (index != ParallelKernels::NotFound) {
+            result.index = index;
+        }
+        result.version = version_.load(std::memory_order_acquire);
+        return result;
+    }
+
+    // Shared body of modify()/modify_unchecked(). With Checked, the bound is
+    // tested once through AccessPolicy; element access itself is unchecked.
+    template <bool Checked>
+    void assign_element(size_t index, const T& newValue) {
+        std::optional<T> old_value;
+        {
+            ElementLock lock(mutex_, lock_policy_, index);
+            if constexpr (Checked) {
+                if (!AccessPolicy::accept(index, data_.size())) {
+                    return;
+                }
+            }
+            T& slot = Access::get_unchecked(data_, index);
+            if (slot == newValue) { // Optional: notify only if value actually changes
+                return;
+            }
+            if constexpr (emits(ChangeType::ElementModified)) {
+                old_value.emplace(std::move(slot)); // Slot is overwritten next, move instead of copy
+            }
+            slot = newValue;
+            note_change_locked<ChangeType::ElementModified>();
+        }
+        if constexpr (emits(ChangeType::ElementModified)) {
+            notify(ChangeType::ElementModified, index, std::move(old_value), newValue);
+        }
+    }
+
+    template <bool Checked>
+    void assign_element(size_t index, T&& newValue) {
+        std::optional<T> old_value;
+        std::optional<T> final_new_value; // To capture the state of newValue after the move
+        {
+            ElementLock lock(mutex_, lock_policy_, index);
+            if constexpr (Checked) {
+                if (!AccessPolicy::accept(index, data_.size())) {
+                    return;
+                }
+            }
+            T& slot = Access::get_unchecked(data_, index);
+            if constexpr (emits(ChangeType::ElementModified)) {
+                old_value.emplace(std::move(slot));
+                slot = std::move(newValue);
+                // The most accurate newValue for notification is the stored element.
+                // Move-only T cannot be copied, so its event carries only oldValue.
+                if constexpr (std::is_copy_constructible_v<T>) {
+                    final_new_value.emplace(slot);
+                }
+            } else {
+                slot = std::move(newValue);
+            }
+            note_change_locked<ChangeType::ElementModified>();
+        }
+        if constexpr (emits(ChangeType::ElementModified)) {
+            notify(ChangeType::ElementModified, index, std::move(old_value), std::move(final_new_value));
+        }
+    }
+
 public:
     ObservableContainer() = default;
 
     // Copy Constructor
+    // Large random-access containers are copied in parallel chunks (see
+    // copy_data()), so the source lock is held for a fraction of the time.
     ObservableContainer(const ObservableContainer& other)
         : observers_(), 
           defer_level_(0),      
           batch_changed_(false) 
     {
-        std::lock_guard<std::mutex> lock(other.mutex_); 
-        data_ = other.data_; 
+        std::lock_guard<mutex_type> lock(other.mutex_); 
+        copy_data(data_, other.data_); 
+    }
+
+    // Bulk load: fills the new container from `range` without any per-element
+    // work beyond the copy (a new container has no observers to notify). An
+    // rvalue of the underlying container type is moved in; other sized
+    // random-access ranges are copied in parallel chunks when large.
+    template <typename Range>
+    ObservableContainer(from_range_t, Range&& range) {
+        using Underlying = ActualContainer<T, Allocator>;
+        if constexpr (std::is_same_v<std::decay_t<Range>, Underlying> && !std::is_lvalue_reference_v<Range>) {
+            data_ = std::move(range);
+        } else if constexpr (std::is_same_v<std::decay_t<Range>, Underlying>) {
+            copy_data(data_, range);
+        } else {
+            using std::begin;
+            using std::end;
+            auto first = begin(range);
+            auto last = end(range);
+            using SourceIterator = decltype(first);
+            if constexpr (std::is_base_of_v<std::random_access_iterator_tag,
+                                            typename std::iterator_traits<SourceIterator>::iterator_category>) {
+                copy_chunked(data_, first, static_cast<size_t>(last - first));
+            } else {
+                data_.assign(first, last);
+            }
+        }
     }
 
     // Copy Assignment Operator
@@ -164,9 +689,10 @@ public:
         { 
             std::scoped_lock lock(mutex_, other.mutex_);
             // Assuming ActualContainer supports operator!= for comparison
-            if (data_ != other.data_) { 
-                data_ = other.data_;
+            if (!equal_data(data_, other.data_)) { 
+                copy_data(data_, other.data_);
                 data_actually_changed = true;
+                version_.fetch_add(1, std::memory_order_release);
             }
             // Deliberately clear existing observers on this container.
             // Observers are considered specific to the container's lifecycle and identity.
@@ -176,7 +702,7 @@ public:
             defer_level_ = 0;   
             batch_changed_ = false; 
         } 
-        if (data_actually_changed) {
+        if (data_actually_changed && emits(ChangeType::BatchUpdate)) {
             // Notify for BatchUpdate. Since observers_ was cleared, this notification
             // will not be received by any pre-existing observers of this instance.
             // It serves as a hook for observers added *after* this assignment,
@@ -189,11 +715,11 @@ public:
     // Move Constructor
     ObservableContainer(ObservableContainer&& other) noexcept
     {
-        std::lock_guard<std::mutex> lock(other.mutex_); 
+        std::lock_guard<mutex_type> lock(other.mutex_); 
         data_ = std::move(other.data_);
         // observers_ list is default-initialized (empty)
         defer_level_ = other.defer_level_;
-        batch_changed_ = other.batch_changed_;
+        batch_changed_ = other.batch_changed_.load();
         other.data_.clear(); 
         other.observers_.clear(); 
         other.defer_level_ = 0;
@@ -209,6 +735,7 @@ public:
         { 
             std::scoped_lock lock(mutex_, other.mutex_);
             data_ = std::move(other.data_);
+            version_.fetch_add(1, std::memory_order_release);
 
             // Deliberately clear existing observers on this container, similar to copy assignment.
             // The container's state is being entirely replaced by the moved content.
@@ -220,7 +747,7 @@ public:
             // Consider if 'this' container's defer_level/batch_changed should be reset or also retain its value.
             // Current behavior: take from 'other'.
             defer_level_ = other.defer_level_;
-            batch_changed_ = other.batch_changed_;
+            batch_changed_ = other.batch_changed_.load();
             
             other.data_.clear(); 
             other.observers_.clear(); // Observers of 'other' are cleared.
@@ -231,21 +758,23 @@ public:
         // Notify for BatchUpdate. Since observers_ on 'this' was cleared, this notification
         // will not be received by any pre-existing observers of this instance.
         // It serves as a hook for observers added *after* this assignment.
-        notify(ChangeType::BatchUpdate);
+        if constexpr (emits(ChangeType::BatchUpdate)) {
+            notify(ChangeType::BatchUpdate);
+        }
         return *this;
     }
 
     // ObserverCallback is already public
 
     void beginUpdate() {
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::lock_guard<mutex_type> lock(mutex_);
         defer_level_++;
     }
 
     void endUpdate() {
         bool should_notify_batch_update = false;
         { 
-            std::lock_guard<std::mutex> lock(mutex_);
+            std::lock_guard<mutex_type> lock(mutex_);
             if (defer_level_ > 0) { 
                 defer_level_--;
                 if (defer_level_ == 0 && batch_changed_) {
@@ -254,34 +783,46 @@ public:
                 }
             }
         } 
-        if (should_notify_batch_update) {
-            notify(ChangeType::BatchUpdate);
+        if constexpr (emits(ChangeType::BatchUpdate)) {
+            if (should_notify_batch_update) {
+                notify(ChangeType::BatchUpdate);
+            }
         }
     }
 
     ObserverHandle addObserver(const ObserverCallback& observer) {
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::lock_guard<mutex_type> lock(mutex_);
         ObserverHandle handle = ++nextHandleId_;
-        observers_.push_back({handle, observer});
+        observers_.push_back({handle, observer, nullptr});
+        return handle;
+    }
+
+    // Registers an observer that is only invoked for events matching `predicate`,
+    // e.g. [](const ChangeEvent<T>& e) { return e.newValue && e.newValue->price > limit; }.
+    // BatchUpdate events are filtered like any other event.
+    ObserverHandle addObserver(const ObserverCallback& observer, const ObserverPredicate& predicate) {
+        std::lock_guard<mutex_type> lock(mutex_);
+        ObserverHandle handle = ++nextHandleId_;
+        observers_.push_back({handle, observer, predicate});
         return handle;
     }
 
     bool removeObserver(ObserverHandle handle) {
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::lock_guard<mutex_type> lock(mutex_);
         const auto original_size = observers_.size();
-        observers_.remove_if([handle](const auto& pair) {
-            return pair.first == handle;
+        observers_.remove_if([handle](const auto& entry) {
+            return entry.handle == handle;
         });
         return observers_.size() < original_size;
     }
 
     size_t size() const noexcept {
-        std::lock_guard<std::mutex> lock(mutex_);
+        SharedLock lock(mutex_);
         return data_.size();
     }
 
     bool empty() const noexcept {
-        std::lock_guard<std::mutex> lock(mutex_);
+        SharedLock lock(mutex_);
         return data_.empty();
     }
 
@@ -289,86 +830,270 @@ public:
     void push_back(const T& value) {
         size_t pushed_at_index;
         {
-            std::lock_guard<std::mutex> lock(mutex_);
+            std::lock_guard<mutex_type> lock(mutex_);
             data_.push_back(value);
             pushed_at_index = data_.size() - 1; 
+            note_change_locked<ChangeType::ElementAdded, ChangeType::SizeChanged>();
+        }
+        if constexpr (emits(ChangeType::ElementAdded)) {
+            notify(ChangeType::ElementAdded, pushed_at_index, std::nullopt, value, emits(ChangeType::SizeChanged));
         }
-        notify(ChangeType::ElementAdded, pushed_at_index, std::nullopt, value);
-        notify(ChangeType::SizeChanged);
+        notify_size_changed();
     }
 
     void push_back(T&& value) {
         size_t pushed_at_index;
         // The 'value' parameter will be in a moved-from state after data_.push_back.
         // For notification, we need the value as it exists in the container.
+        std::optional<T> new_value_in_container;
         {
-            std::lock_guard<std::mutex> lock(mutex_);
+            std::lock_guard<mutex_type> lock(mutex_);
             data_.push_back(std::move(value)); // Moves value
             pushed_at_index = data_.size() - 1;
+            // Copy the stored element for the event in the same critical section.
+            // Move-only T cannot be copied, so its ElementAdded carries no newValue.
+            if constexpr (emits(ChangeType::ElementAdded) && std::is_copy_constructible_v<T>) {
+                new_value_in_container.emplace(data_.back());
+            }
+            note_change_locked<ChangeType::ElementAdded, ChangeType::SizeChanged>();
         }
 
-        T new_value_in_container;
-        {
-            // Re-acquire lock to safely access the element for notification.
-            // This ensures thread-safety if other operations could occur.
-            std::lock_guard<std::mutex> lock(mutex_);
-            // Use ObservableContainerHelpers::ContainerAccess to get the value
-            // as it abstracts away differences between std::vector and std::list for .at() vs iterating.
-            new_value_in_container = ObservableContainerHelpers::ContainerAccess<ActualContainer<T, Allocator>, T>::get(data_, pushed_at_index);
+        if constexpr (emits(ChangeType::ElementAdded)) {
+            notify(ChangeType::ElementAdded, pushed_at_index, std::nullopt, std::move(new_value_in_container),
+                   emits(ChangeType::SizeChanged));
         }
+        notify_size_changed();
+    }
 
-        notify(ChangeType::ElementAdded, pushed_at_index, std::nullopt, new_value_in_container);
-        notify(ChangeType::SizeChanged);
+    // Appends every element of `range` (moved out of an rvalue range) under
+    // one lock and emits its events as one call, like transfer(): one
+    // ElementAdded per element with a copy of its value (a single ranged
+    // ElementAdded for move-only T or without observers) plus SizeChanged,
+    // so views apply a materialized chunk incrementally.
+    template <typename Range>
+    void append_range(Range&& range) {
+        size_t first = 0;
+        size_t appended = 0;
+        std::vector<ChangeEvent<T>> events;
+        {
+            std::lock_guard<mutex_type> lock(mutex_);
+            first = data_.size();
+            if constexpr (std::is_lvalue_reference_v<Range>) {
+                data_.insert(data_.end(), std::begin(range), std::end(range));
+            } else {
+                data_.insert(data_.end(), std::make_move_iterator(std::begin(range)), std::make_move_iterator(std::end(range)));
+            }
+            appended = data_.size() - first;
+            if (appended == 0) {
+                return;
+            }
+            note_change_locked<ChangeType::ElementAdded, ChangeType::SizeChanged>();
+            events = range_events_locked(ChangeType::ElementAdded, first, appended,
+                                         std::next(data_.cbegin(), static_cast<std::ptrdiff_t>(first)));
+        }
+        notify_recorded(events);
     }
 
     void pop_back() {
         bool modified = false;
-        T old_value;
+        std::optional<T> old_value;
         size_t original_size = 0;
         {
-            std::lock_guard<std::mutex> lock(mutex_);
+            std::lock_guard<mutex_type> lock(mutex_);
             if (!data_.empty()) {
                 original_size = data_.size();
-                old_value = data_.back(); 
+                if constexpr (emits(ChangeType::ElementRemoved)) {
+                    old_value.emplace(std::move(data_.back())); // Move out, the slot is destroyed next
+                }
                 data_.pop_back();
                 modified = true;
+                note_change_locked<ChangeType::ElementRemoved, ChangeType::SizeChanged>();
             }
         }
         if (modified) {
-            notify(ChangeType::ElementRemoved, original_size - 1, old_value, std::nullopt);
-            notify(ChangeType::SizeChanged);
+            if constexpr (emits(ChangeType::ElementRemoved)) {
+                notify(ChangeType::ElementRemoved, original_size - 1, std::move(old_value), std::nullopt,
+                       emits(ChangeType::SizeChanged));
+            }
+            notify_size_changed();
         }
     }
     
+    // Removal with move-out.
+    // The removed element is moved once, into the ElementRemoved event; after
+    // observers have seen it by reference it is moved on to the caller. Unlike
+    // back()+pop_back() this takes a single critical section and no copies.
+
+    // Removes and returns the last element. Throws std::out_of_range if empty.
+    T take_back() {
+        ChangeEvent<T> event{ChangeType::ElementRemoved};
+        {
+            std::lock_guard<mutex_type> lock(mutex_);
+            if (data_.empty()) {
+                throw std::out_of_range("take_back() on empty container");
+            }
+            event.index = data_.size() - 1;
+            take_locked(data_.size() - 1, event);
+            note_change_locked<ChangeType::ElementRemoved, ChangeType::SizeChanged>();
+        }
+        if constexpr (emits(ChangeType::ElementRemoved)) {
+            event.continues = emits(ChangeType::SizeChanged);
+            notify(event);
+        }
+        notify_size_changed();
+        return std::move(*event.oldValue);
+    }
+
+    // Removes and returns the element at `index`. Throws std::out_of_range.
+    T take(size_t index) {
+        ChangeEvent<T> event{ChangeType::ElementRemoved, index};
+        {
+            std::lock_guard<mutex_type> lock(mutex_);
+            if (index >= data_.size()) {
+                throw std::out_of_range("Index out of range");
+            }
+            take_locked(index, event);
+            note_change_locked<ChangeType::ElementRemoved, ChangeType::SizeChanged>();
+        }
+        if constexpr (emits(ChangeType::ElementRemoved)) {
+            event.continues = emits(ChangeType::SizeChanged);
+            notify(event);
+        }
+        notify_size_changed();
+        return std::move(*event.oldValue);
+    }
+
+    // Removes and returns the elements [first, last). One ElementRemoved is
+    // emitted per element, each at index `first` (the order a mirror would
+    // apply them), followed by a single SizeChanged.
+    // Throws std::out_of_range unless first <= last <= size().
+    std::vector<T> extract_range(size_t first, size_t last) {
+        std::vector<ChangeEvent<T>> events;
+        {
+            std::lock_guard<mutex_type> lock(mutex_);
+            if (first > last || last > data_.size()) {
+                throw std::out_of_range("extract_range() bounds out of range");
+            }
+            events.reserve(last - first);
+            auto range_begin = data_.begin();
+            std::advance(range_begin, first);
+            auto range_end = range_begin;
+            for (size_t i = first; i < last; ++i, ++range_end) {
+                events.emplace_back(ChangeType::ElementRemoved, first);
+                events.back().oldValue.emplace(std::move(*range_end));
+                events.back().continues = i + 1 < last || emits(ChangeType::SizeChanged);
+            }
+            data_.erase(range_begin, range_end);
+            if (first != last) {
+                note_change_locked<ChangeType::ElementRemoved, ChangeType::SizeChanged>();
+            }
+        }
+        std::vector<T> extracted;
+        if (events.empty()) {
+            return extracted;
+        }
+        extracted.reserve(events.size());
+        for (auto& event : events) {
+            if constexpr (emits(ChangeType::ElementRemoved)) {
+                notify(event);
+            }
+            extracted.push_back(std::move(*event.oldValue));
+        }
+        notify_size_changed();
+        return extracted;
+    }
+
     T& front() {
-        std::lock_guard<std::mutex> lock(mutex_);
+        SharedLock lock(mutex_);
         return data_.front();
     }
 
     const T& front() const {
-        std::lock_guard<std::mutex> lock(mutex_);
+        SharedLock lock(mutex_);
         return data_.front();
     }
 
     T& back() {
-        std::lock_guard<std::mutex> lock(mutex_);
+        SharedLock lock(mutex_);
         return data_.back();
     }
 
     const T& back() const {
-        std::lock_guard<std::mutex> lock(mutex_);
+        SharedLock lock(mutex_);
         return data_.back();
     }
 
-    // New at() methods using ContainerAccess
+    // New at() methods using ContainerAccess; the bound is checked per AccessPolicy
     T& at(size_t index) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return ObservableContainerHelpers::ContainerAccess<ActualContainer<T, Allocator>, T>::get(data_, index);
+        ElementLock lock(mutex_, lock_policy_, index);
+        AccessPolicy::require(index, data_.size());
+        return Access::get_unchecked(data_, index);
     }
 
     const T& at(size_t index) const { // Renamed from const_at
-        std::lock_guard<std::mutex> lock(mutex_);
-        return ObservableContainerHelpers::ContainerAccess<ActualContainer<T, Allocator>, T>::get(data_, index);
+        ElementLock lock(mutex_, lock_policy_, index);
+        AccessPolicy::require(index, data_.size());
+        return Access::get_unchecked(data_, index);
+    }
+
+    // Unchecked access for validated inner loops: no bounds check under any policy.
+    T& at_unchecked(size_t index) {
+        ElementLock lock(mutex_, lock_policy_, index);
+        return Access::get_unchecked(data_, index);
+    }
+
+    const T& at_unchecked(size_t index) const {
+        ElementLock lock(mutex_, lock_policy_, index);
+        return Access::get_unchecked(data_, index);
+    }
+
+    // Paged reads for viewport consumers: one lock acquisition per page
+    // instead of one per at() call. The structural mutex is held exclusively
+    // so that, under StripedLocking, no modify() touches the page mid-copy.
+
+    // Copies up to `count` elements starting at `offset` to `out` and returns
+    // how many were copied (0 if offset >= size()). A plain memcpy for
+    // trivially copyable T stored in a std::vector.
+    size_t read_page(size_t offset, size_t count, T* out) const {
+        std::lock_guard<mutex_type> lock(mutex_);
+        const size_t n = page_length_locked(offset, count);
+        copy_page_locked(offset, n, out);
+        return n;
+    }
+
+    // Replaces the contents of `out` with the page; returns its length.
+    size_t read_page(size_t offset, size_t count, std::vector<T>& out) const {
+        std::lock_guard<mutex_type> lock(mutex_);
+        const size_t n = page_length_locked(offset, count);
+        if constexpr (page_is_memcpy) {
+            out.resize(n);
+            copy_page_locked(offset, n, out.data());
+        } else {
+            out.clear();
+            out.reserve(n);
+            auto it = data_.cbegin();
+            std::advance(it, offset);
+            for (size_t i = 0; i < n; ++i, ++it) {
+                out.push_back(*it);
+            }
+        }
+        return n;
+    }
+
+    // Calls fn(const T&) for the elements [first, last) in order, under one
+    // lock acquisition. fn must not call back into the container.
+    // Throws std::out_of_range unless first <= last <= size().
+    template <typename Fn>
+    void visit_range(size_t first, size_t last, Fn&& fn) const {
+        std::lock_guard<mutex_type> lock(mutex_);
+        if (first > last || last > data_.size()) {
+            throw std::out_of_range("visit_range() bounds out of range");
+        }
+        auto it = data_.cbegin();
+        std::advance(it, first);
+        for (size_t i = first; i < last; ++i, ++it) {
+            fn(*it);
+        }
     }
 
     // Iterators
@@ -376,46 +1101,47 @@ public:
     using const_iterator = typename ActualContainer<T, Allocator>::const_iterator;
 
     iterator begin() noexcept {
-        std::lock_guard<std::mutex> lock(mutex_);
+        SharedLock lock(mutex_);
         return data_.begin();
     }
 
     const_iterator begin() const noexcept {
-        std::lock_guard<std::mutex> lock(mutex_);
+        SharedLock lock(mutex_);
         return data_.begin();
     }
 
     iterator end() noexcept {
-        std::lock_guard<std::mutex> lock(mutex_);
+        SharedLock lock(mutex_);
         return data_.end();
     }
 
     const_iterator end() const noexcept {
-        std::lock_guard<std::mutex> lock(mutex_);
+        SharedLock lock(mutex_);
         return data_.end();
     }
 
     const_iterator cbegin() const noexcept {
-        std::lock_guard<std::mutex> lock(mutex_);
+        SharedLock lock(mutex_);
         return data_.cbegin();
     }
 
     const_iterator cend() const noexcept {
-        std::lock_guard<std::mutex> lock(mutex_);
+        SharedLock lock(mutex_);
         return data_.cend();
     }
 
     void clear() {
         bool was_not_empty = false;
         { 
-            std::lock_guard<std::mutex> lock(mutex_);
+            std::lock_guard<mutex_type> lock(mutex_);
             if (!data_.empty()) {
                 was_not_empty = true;
                 data_.clear();
+                note_change_locked<ChangeType::SizeChanged>();
             }
         } 
         if (was_not_empty) {
-            notify(ChangeType::SizeChanged);
+            notify_size_changed();
         }
     }
 
@@ -424,7 +1150,7 @@ public:
         ptrdiff_t insert_idx = -1;
         size_t current_size = 0;
         {
-            std::lock_guard<std::mutex> lock(mutex_);
+            std::lock_guard<mutex_type> lock(mutex_);
             current_size = data_.size();
             // For std::list, pos needs to be converted to a non-const iterator if insert takes non-const
             // For std::vector, pos can be const. std::list::insert takes const_iterator.
@@ -441,6 +1167,7 @@ public:
 
             if (insert_idx >= 0 && static_cast<size_t>(insert_idx) <= current_size) {
                  result_it = data_.insert(pos, value); // Use original pos (const_iterator)
+                 note_change_locked<ChangeType::ElementAdded, ChangeType::SizeChanged>();
             } else {
                  result_it = data_.end(); 
                  insert_idx = -1; 
@@ -448,8 +1175,11 @@ public:
         }
 
         if (insert_idx != -1) {
-            notify(ChangeType::ElementAdded, static_cast<size_t>(insert_idx), std::nullopt, value);
-            notify(ChangeType::SizeChanged);
+            if constexpr (emits(ChangeType::ElementAdded)) {
+                notify(ChangeType::ElementAdded, static_cast<size_t>(insert_idx), std::nullopt, value,
+                       emits(ChangeType::SizeChanged));
+            }
+            notify_size_changed();
         }
         return result_it;
     }
@@ -457,21 +1187,26 @@ public:
     iterator erase(const_iterator pos) {
         iterator result_it;
         bool erased = false;
-        T old_value;
+        std::optional<T> old_value;
         ptrdiff_t erase_idx = -1;
         size_t current_size = 0;
         {
-            std::lock_guard<std::mutex> lock(mutex_);
+            std::lock_guard<mutex_type> lock(mutex_);
             current_size = data_.size();
             erase_idx = std::distance(data_.cbegin(), pos);
 
             if (erase_idx >= 0 && static_cast<size_t>(erase_idx) < current_size) {
-                // Need to capture old_value before erasing
-                // For std::list, *pos is fine. For vector, also *pos.
-                old_value = *pos; 
+                // Move old_value out before erasing; 'pos' is const, so reach the
+                // same element through a mutable iterator.
+                if constexpr (emits(ChangeType::ElementRemoved)) {
+                    auto it = data_.begin();
+                    std::advance(it, erase_idx);
+                    old_value.emplace(std::move(*it));
+                }
                 // std::list::erase and std::vector::erase take const_iterator
                 result_it = data_.erase(pos);
                 erased = true;
+                note_change_locked<ChangeType::ElementRemoved, ChangeType::SizeChanged>();
             } else {
                 result_it = data_.end(); 
                 erase_idx = -1;
@@ -479,51 +1214,593 @@ public:
         }
 
         if (erased) {
-            notify(ChangeType::ElementRemoved, static_cast<size_t>(erase_idx), old_value, std::nullopt);
-            notify(ChangeType::SizeChanged);
+            if constexpr (emits(ChangeType::ElementRemoved)) {
+                notify(ChangeType::ElementRemoved, static_cast<size_t>(erase_idx), std::move(old_value), std::nullopt,
+                       emits(ChangeType::SizeChanged));
+            }
+            notify_size_changed();
         }
         return result_it;
     }
 
-    // Modify using ContainerAccess helper
+    // Modify using ContainerAccess helper.
+    // modify() never changes the size, so it only takes an ElementLock: under
+    // StripedLocking, modifies of elements on different stripes run concurrently.
+    // Out-of-range indices are handled per AccessPolicy (ignored by default).
     void modify(size_t index, const T& newValue) {
-        bool modified_flag = false;
-        T old_value;
+        assign_element<true>(index, newValue);
+    }
+
+    void modify(size_t index, T&& newValue) {
+        assign_element<true>(index, std::move(newValue));
+    }
+
+    // As modify(), without any bounds check: the caller guarantees index < size().
+    void modify_unchecked(size_t index, const T& newValue) {
+        assign_element<false>(index, newValue);
+    }
+
+    void modify_unchecked(size_t index, T&& newValue) {
+        assign_element<false>(index, std::move(newValue));
+    }
+
+    // Atomic read-modify-write operations.
+    // Each one reads, decides and writes inside a single ElementLock critical
+    // section (only the element's stripe under StripedLocking), so concurrent
+    // callers never lose updates. At most one ElementModified is emitted, and
+    // only if the stored value actually changed. Out-of-range indices are
+    // rejected per AccessPolicy, like at() (std::out_of_range by default).
+
+    // Stores `desired` if the element equals `expected` and returns true.
+    // Otherwise loads the current element into `expected` and returns false.
+    bool compare_exchange(size_t index, T& expected, const T& desired) {
+        bool exchanged = false;
+        std::optional<T> old_value;
         {
-            std::lock_guard<std::mutex> lock(mutex_);
-            if (index < data_.size()) {
-                old_value = ObservableContainerHelpers::ContainerAccess<ActualContainer<T, Allocator>, T>::get(data_, index);
-                if (old_value != newValue) { // Optional: notify only if value actually changes
-                    ObservableContainerHelpers::ContainerAccess<ActualContainer<T, Allocator>, T>::set(data_, index, newValue);
-                    modified_flag = true;
+            ElementLock lock(mutex_, lock_policy_, index);
+            AccessPolicy::require(index, data_.size());
+            T& slot = Access::get_unchecked(data_, index);
+            if (slot == expected) {
+                exchanged = true;
+                if (slot != desired) {
+                    if constexpr (emits(ChangeType::ElementModified)) {
+                        old_value.emplace(std::move(slot));
+                    }
+                    slot = desired;
+                    note_change_locked<ChangeType::ElementModified>();
                 }
+            } else {
+                expected = slot;
             }
         }
-        if (modified_flag) {
-            notify(ChangeType::ElementModified, index, old_value, newValue);
+        if constexpr (emits(ChangeType::ElementModified)) {
+            if (old_value) {
+                notify(ChangeType::ElementModified, index, std::move(old_value), desired);
+            }
         }
+        return exchanged;
     }
 
-    void modify(size_t index, T&& newValue) {
-        bool modified_flag = false;
-        T old_value;
-        T final_new_value; // To capture the state of newValue after potential move
+    // Adds `delta` to the element and returns its previous value.
+    T fetch_add(size_t index, const T& delta) {
+        std::optional<T> old_value;
+        std::optional<T> new_value;
         {
-            std::lock_guard<std::mutex> lock(mutex_);
-            if (index < data_.size()) {
-                old_value = ObservableContainerHelpers::ContainerAccess<ActualContainer<T, Allocator>, T>::get(data_, index);
-                // Capture newValue for notification *before* it's moved from if it's an rvalue reference
-                // If T is a simple type, this is just a copy. If T is complex, this might copy.
-                // This is tricky. The most accurate newValue for notification is data_[index] after modification.
-                ObservableContainerHelpers::ContainerAccess<ActualContainer<T, Allocator>, T>::set(data_, index, std::move(newValue));
-                modified_flag = true; 
-                final_new_value = ObservableContainerHelpers::ContainerAccess<ActualContainer<T, Allocator>, T>::get(data_, index);
+            ElementLock lock(mutex_, lock_policy_, index);
+            AccessPolicy::require(index, data_.size());
+            T& slot = Access::get_unchecked(data_, index);
+            old_value.emplace(slot);
+            slot = slot + delta;
+            if (slot != *old_value) {
+                if constexpr (emits(ChangeType::ElementModified)) {
+                    new_value.emplace(slot);
+                }
+                note_change_locked<ChangeType::ElementModified>();
+            }
+        }
+        if constexpr (emits(ChangeType::ElementModified)) {
+            if (new_value) {
+                T previous = *old_value;
+                notify(ChangeType::ElementModified, index, std::move(old_value), std::move(new_value));
+                return previous;
+            }
+        }
+        return std::move(*old_value);
+    }
+
+    // Replaces the element with `fn(current)` and returns the stored value.
+    // `fn` runs while the element lock is held and must not call back into
+    // this container.
+    template <typename UpdateFn>
+    T update(size_t index, UpdateFn&& fn) {
+        std::optional<T> old_value;
+        std::optional<T> result;
+        {
+            ElementLock lock(mutex_, lock_policy_, index);
+            AccessPolicy::require(index, data_.size());
+            T& slot = Access::get_unchecked(data_, index);
+            T updated = std::forward<UpdateFn>(fn)(static_cast<const T&>(slot));
+            if (updated != slot) {
+                if constexpr (emits(ChangeType::ElementModified)) {
+                    old_value.emplace(std::move(slot));
+                }
+                slot = std::move(updated);
+                note_change_locked<ChangeType::ElementModified>();
+            }
+            result.emplace(slot);
+        }
+        if constexpr (emits(ChangeType::ElementModified)) {
+            if (old_value) {
+                notify(ChangeType::ElementModified, index, std::move(old_value), *result);
+            }
+        }
+        return std::move(*result);
+    }
+
+    // Number of observed mutations so far. Writes through non-const
+    // references (operator[], at(), iterators) bypass it.
+    uint64_t version() const noexcept {
+        return version_.load(std::memory_order_acquire);
+    }
+
+    // Container-level searches over a consistent view: the structural mutex
+    // is held exclusively for the whole search, so the result refers to one
+    // version of the container. Random-access containers use the blocked
+    // kernels in ParallelKernels.h and, per `policy`, split large searches
+    // across ThreadPool::shared(); std::list is scanned sequentially.
+    // Predicates and comparators may run concurrently on several threads and
+    // must not call back into the container.
+
+    template <typename Pred>
+    SearchResult find_if(Pred pred, ExecutionPolicy policy = ExecutionPolicy::Auto) const {
+        std::lock_guard<mutex_type> lock(mutex_);
+        return indexResult(search_locked(policy, [&](auto first, size_t n, ExecutionPolicy p) {
+            return ParallelKernels::findFirst(first, n, pred, p, ThreadPool::shared());
+        }, [&] {
+            size_t index = 0;
+            for (auto it = data_.cbegin(); it != data_.cend(); ++it, ++index) {
+                if (pred(*it)) return index;
+            }
+            return ParallelKernels::NotFound;
+        }));
+    }
+
+    SearchResult find(const T& value, ExecutionPolicy policy = ExecutionPolicy::Auto) const {
+        return find_if([&value](const T& element) { return element == value; }, policy);
+    }
+
+    template <typename Pred>
+    bool any_of(Pred pred, ExecutionPolicy policy = ExecutionPolicy::Auto) const {
+        return find_if(std::move(pred), policy).index.has_value();
+    }
+
+    template <typename Pred>
+    size_t count_if(Pred pred, ExecutionPolicy policy = ExecutionPolicy::Auto) const {
+        std::lock_guard<mutex_type> lock(mutex_);
+        return search_locked(policy, [&](auto first, size_t n, ExecutionPolicy p) {
+            return ParallelKernels::countMatches(first, n, pred, p, ThreadPool::shared());
+        }, [&] {
+            size_t count = 0;
+            for (auto it = data_.cbegin(); it != data_.cend(); ++it) {
+                count += pred(*it) ? 1 : 0;
+            }
+            return count;
+        });
+    }
+
+    size_t count(const T& value, ExecutionPolicy policy = ExecutionPolicy::Auto) const {
+        return count_if([&value](const T& element) { return element == value; }, policy);
+    }
+
+    // Index of the first smallest element under `compare` (empty if the
+    // container is empty).
+    template <typename Compare = std::less<T>>
+    SearchResult min_element(Compare compare = Compare(), ExecutionPolicy policy = ExecutionPolicy::Auto) const {
+        std::lock_guard<mutex_type> lock(mutex_);
+        return indexResult(search_locked(policy, [&](auto first, size_t n, ExecutionPolicy p) {
+            return ParallelKernels::findMin(first, n, compare, p, ThreadPool::shared());
+        }, [&] {
+            auto best = std::min_element(data_.cbegin(), data_.cend(), compare);
+            return best == data_.cend() ? ParallelKernels::NotFound
+                                        : static_cast<size_t>(std::distance(data_.cbegin(), best));
+        }));
+    }
+
+    // Index of the first largest element under `compare`.
+    template <typename Compare = std::less<T>>
+    SearchResult max_element(Compare compare = Compare(), ExecutionPolicy policy = ExecutionPolicy::Auto) const {
+        return min_element([compare](const T& a, const T& b) { return compare(b, a); }, policy);
+    }
+
+    // In-place reordering. Elements are moved, never copied (std::list
+    // relinks its nodes), and each call emits at most one Permuted event
+    // covering the range that actually moved; an unchanged order emits
+    // nothing. Mirrors replay the event with permute().
+
+    // Exchanges two elements. Emits two ElementModified events (i, then j;
+    // the first marked as continued, so History undoes them as one step)
+    // rather than a Permuted event, whose permutation would span every
+    // position between them. Move-only T is exchanged by moves and its
+    // events carry no values. Throws std::out_of_range unless both indices
+    // are < size().
+    void swap(size_t i, size_t j) {
+        std::optional<T> value_i;
+        std::optional<T> value_j; // Values after the swap
+        {
+            std::lock_guard<mutex_type> lock(mutex_);
+            if (i >= data_.size() || j >= data_.size()) {
+                throw std::out_of_range("swap() index out of range");
+            }
+            if (i == j) {
+                return;
+            }
+            T& a = Access::get_unchecked(data_, i);
+            T& b = Access::get_unchecked(data_, j);
+            std::swap(a, b);
+            if constexpr (emits(ChangeType::ElementModified) && std::is_copy_constructible_v<T>) {
+                value_i.emplace(a);
+                value_j.emplace(b);
             }
+            note_change_locked<ChangeType::ElementModified>();
         }
-        if (modified_flag) {
-            notify(ChangeType::ElementModified, index, old_value, final_new_value);
+        if constexpr (emits(ChangeType::ElementModified)) {
+            if constexpr (std::is_copy_constructible_v<T>) {
+                notify(ChangeType::ElementModified, i, value_j, value_i, true);
+                notify(ChangeType::ElementModified, j, std::move(value_i), std::move(value_j));
+            } else {
+                notify(ChangeType::ElementModified, i, std::nullopt, std::nullopt, true);
+                notify(ChangeType::ElementModified, j);
+            }
         }
     }
+
+    void reverse() {
+        std::optional<ChangeEvent<T>> event;
+        {
+            std::lock_guard<mutex_type> lock(mutex_);
+            const size_t n = data_.size();
+            if (n < 2) {
+                return;
+            }
+            std::reverse(data_.begin(), data_.end());
+            std::vector<size_t> order(n);
+            for (size_t k = 0; k < n; ++k) {
+                order[k] = n - 1 - k;
+            }
+            event = note_permuted_locked(0, std::move(order));
+        }
+        notify_permuted(event);
+    }
+
+    // Rotates [first, last) so that `middle` becomes its first element, as
+    // std::rotate. Throws std::out_of_range unless first <= middle <= last <= size().
+    void rotate(size_t first, size_t middle, size_t last) {
+        std::optional<ChangeEvent<T>> event;
+        {
+            std::lock_guard<mutex_type> lock(mutex_);
+            if (first > middle || middle > last || last > data_.size()) {
+                throw std::out_of_range("rotate() bounds out of range");
+            }
+            if (first == middle || middle == last) {
+                return;
+            }
+            auto begin = std::next(data_.begin(), first);
+            std::rotate(begin, std::next(begin, middle - first), std::next(begin, last - first));
+            const size_t length = last - first;
+            std::vector<size_t> order(length);
+            for (size_t k = 0; k < length; ++k) {
+                order[k] = (k + middle - first) % length;
+            }
+            event = note_permuted_locked(first, std::move(order));
+        }
+        notify_permuted(event);
+    }
+
+    // Moves the elements satisfying `pred` before the others, keeping the
+    // relative order within both groups; returns the index of the first
+    // element of the second group. `pred` runs once per element under the
+    // lock and must not call back into the container.
+    template <typename Pred>
+    size_t stable_partition(Pred pred) {
+        std::optional<ChangeEvent<T>> event;
+        size_t point = 0;
+        {
+            std::lock_guard<mutex_type> lock(mutex_);
+            std::vector<size_t> order(data_.size());
+            std::vector<size_t> rejected;
+            size_t index = 0;
+            for (auto it = data_.cbegin(); it != data_.cend(); ++it, ++index) {
+                if (pred(*it)) {
+                    order[point++] = index;
+                } else {
+                    rejected.push_back(index);
+                }
+            }
+            std::copy(rejected.begin(), rejected.end(), order.begin() + static_cast<std::ptrdiff_t>(point));
+            event = reorder_locked(0, std::move(order));
+        }
+        notify_permuted(event);
+        return point;
+    }
+
+    // Stable sort by `compare`. The permutation is computed by sorting
+    // indices; large containers sort chunks of it on ThreadPool::shared()
+    // per `policy` and merge them pairwise in parallel rounds. `compare` may
+    // run on several threads and must not call back into the container.
+    template <typename Compare = std::less<T>>
+    void sort(Compare compare = Compare(), ExecutionPolicy policy = ExecutionPolicy::Auto) {
+        std::optional<ChangeEvent<T>> event;
+        {
+            std::lock_guard<mutex_type> lock(mutex_);
+            std::vector<size_t> order(data_.size());
+            std::iota(order.begin(), order.end(), size_t(0));
+            if constexpr (std::is_base_of_v<std::random_access_iterator_tag,
+                                            typename std::iterator_traits<typename ActualContainer<T, Allocator>::iterator>::iterator_category>) {
+                auto base = data_.cbegin();
+                sort_order(order, [&](size_t a, size_t b) { return compare(base[a], base[b]); }, policy);
+            } else {
+                std::vector<const T*> elements;
+                elements.reserve(data_.size());
+                for (const T& element : data_) {
+                    elements.push_back(&element);
+                }
+                sort_order(order, [&](size_t a, size_t b) { return compare(*elements[a], *elements[b]); }, policy);
+            }
+            event = reorder_locked(0, std::move(order));
+        }
+        notify_permuted(event);
+    }
+
+    // Reorders [first, first + order.size()) so that
+    // new[first + k] == old[first + order[k]], e.g. to replay a Permuted
+    // event on a mirror. Throws std::out_of_range if the range exceeds
+    // size() and std::invalid_argument unless `order` is a permutation of
+    // [0, order.size()).
+    void permute(size_t first, std::vector<size_t> order) {
+        std::optional<ChangeEvent<T>> event;
+        {
+            std::lock_guard<mutex_type> lock(mutex_);
+            require_permutation_locked(first, order);
+            event = reorder_locked(first, std::move(order));
+        }
+        notify_permuted(event);
+    }
+
+    // Guarded view of the elements handed to with_lock(). Reads go straight
+    // to the underlying container; mutators apply immediately and record
+    // their events, which with_lock() dispatches after releasing the lock.
+    // Valid only inside the visitor.
+    class LockedView {
+    public:
+        size_t size() const noexcept { return owner_.data_.size(); }
+        bool empty() const noexcept { return owner_.data_.empty(); }
+
+        // Bound checked per AccessPolicy.
+        const T& at(size_t index) const {
+            AccessPolicy::require(index, owner_.data_.size());
+            return Access::get_unchecked(owner_.data_, index);
+        }
+        const T& operator[](size_t index) const { return Access::get_unchecked(owner_.data_, index); }
+
+        const_iterator begin() const noexcept { return owner_.data_.cbegin(); }
+        const_iterator end() const noexcept { return owner_.data_.cend(); }
+
+        // As ObservableContainer::modify(): an unchanged value records
+        // nothing (when T has operator==), and move-only T records no
+        // newValue.
+        void modify(size_t index, T newValue) {
+            AccessPolicy::require(index, owner_.data_.size());
+            T& slot = Access::get_unchecked(owner_.data_, index);
+            if constexpr (ObservableContainerHelpers::IsEqualityComparable<T>::value) {
+                if (slot == newValue) {
+                    return;
+                }
+            }
+            if constexpr (emits(ChangeType::ElementModified)) {
+                ChangeEvent<T> event{ChangeType::ElementModified, index, std::move(slot)};
+                slot = std::move(newValue);
+                if constexpr (std::is_copy_constructible_v<T>) {
+                    event.newValue.emplace(slot);
+                }
+                record(std::move(event));
+            } else {
+                slot = std::move(newValue);
+            }
+            changed_ = true;
+        }
+
+        // Replaces the element with fn(current); returns the stored value.
+        template <typename UpdateFn>
+        const T& update(size_t index, UpdateFn&& fn) {
+            AccessPolicy::require(index, owner_.data_.size());
+            const T& current = Access::get_unchecked(owner_.data_, index);
+            T updated = std::forward<UpdateFn>(fn)(current);
+            if (updated != current) {
+                modify(index, std::move(updated));
+            }
+            return Access::get_unchecked(owner_.data_, index);
+        }
+
+        void push_back(T value) {
+            insert(owner_.data_.size(), std::move(value));
+        }
+
+        // Inserts before position `index`. Throws std::out_of_range unless
+        // index <= size().
+        void insert(size_t index, T value) {
+            if (index > owner_.data_.size()) {
+                throw std::out_of_range("LockedView::insert() index out of range");
+            }
+            auto pos = owner_.data_.begin();
+            std::advance(pos, index);
+            auto it = owner_.data_.insert(pos, std::move(value));
+            if constexpr (emits(ChangeType::ElementAdded)) {
+                record(ChangeEvent<T>{ChangeType::ElementAdded, index, std::nullopt, *it});
+            }
+            changed_ = resized_ = true;
+        }
+
+        // Throws std::out_of_range unless index < size().
+        void erase(size_t index) {
+            if (index >= owner_.data_.size()) {
+                throw std::out_of_range("LockedView::erase() index out of range");
+            }
+            ChangeEvent<T> event{ChangeType::ElementRemoved, index};
+            owner_.take_locked(index, event);
+            if constexpr (emits(ChangeType::ElementRemoved)) {
+                record(std::move(event));
+            }
+            changed_ = resized_ = true;
+        }
+
+        void pop_back() {
+            if (!owner_.data_.empty()) {
+                erase(owner_.data_.size() - 1);
+            }
+        }
+
+        // As ObservableContainer::permute().
+        void permute(size_t first, std::vector<size_t> order) {
+            owner_.require_permutation_locked(first, order);
+            if (auto event = owner_.reorder_locked(first, std::move(order))) {
+                record(std::move(*event));
+            }
+        }
+
+    private:
+        friend class ObservableContainer;
+
+        explicit LockedView(ObservableContainer& owner) : owner_(owner) {}
+
+        void record(ChangeEvent<T>&& event) { events_.push_back(std::move(event)); }
+
+        ObservableContainer& owner_;
+        std::vector<ChangeEvent<T>> events_;
+        bool changed_ = false;
+        bool resized_ = false;
+    };
+
+    // Runs visitor(LockedView&) while holding the structural mutex
+    // exclusively, so several reads and writes form one atomic step without
+    // external locking. Events recorded by the view's mutators are dispatched
+    // in order once the lock is released, followed by a single SizeChanged if
+    // elements were added or removed. Returns the visitor's result. If the
+    // visitor throws, the changes made so far are kept and still dispatched.
+    // The visitor must not call back into the container.
+    template <typename Visitor>
+    decltype(auto) with_lock(Visitor&& visitor) {
+        LockedView view(*this);
+        std::unique_lock<mutex_type> lock(mutex_);
+        auto finish = [&] {
+            if (view.changed_) {
+                note_change_locked<>();
+            }
+            lock.unlock();
+            if (view.resized_) {
+                if constexpr (emits(ChangeType::SizeChanged)) {
+                    view.events_.emplace_back(ChangeType::SizeChanged);
+                }
+            }
+            notify_recorded(view.events_);
+        };
+        try {
+            if constexpr (std::is_void_v<std::invoke_result_t<Visitor, LockedView&>>) {
+                std::forward<Visitor>(visitor)(view);
+                finish();
+            } else {
+                decltype(auto) result = std::forward<Visitor>(visitor)(view);
+                finish();
+                return result;
+            }
+        } catch (...) {
+            if (lock.owns_lock()) {
+                finish();
+            }
+            throw;
+        }
+    }
+
+    // Incrementally maintained view of the first `k` elements in `compare`
+    // order (the k largest by default). Requires TopKView.h.
+    template <typename Compare = std::greater<T>>
+    TopKView<ObservableContainer, Compare> topK(size_t k, Compare compare = Compare()) {
+        return TopKView<ObservableContainer, Compare>(*this, k, std::move(compare));
+    }
+
+    // Incrementally maintained sorted order with rank/positional access.
+    // Requires SortedView.h.
+    template <typename Compare = std::less<T>>
+    SortedView<ObservableContainer, Compare> sortedView(Compare compare = Compare()) {
+        return SortedView<ObservableContainer, Compare>(*this, std::move(compare));
+    }
+
+    // Incrementally maintained groups keyed by keyFn(element), each with an
+    // aggregate (element count by default; see sumOf()). Requires GroupByView.h.
+    template <typename KeyFn, typename Aggregator = CountAggregator,
+              typename Key = std::decay_t<std::invoke_result_t<KeyFn, const T&>>>
+    GroupByView<ObservableContainer, KeyFn, Aggregator, std::hash<Key>> groupBy(KeyFn keyFn, Aggregator aggregator = Aggregator()) {
+        return GroupByView<ObservableContainer, KeyFn, Aggregator, std::hash<Key>>(*this, std::move(keyFn), std::move(aggregator));
+    }
 };
 
+// Moves the elements [first, last) of `src` to position `pos` of `dst` without
+// copying them. Both containers are locked together for the whole operation.
+// std::list containers with equal allocators relink the nodes via splice();
+// other containers move-construct the range into place (a memmove for
+// trivially copyable T) and then erase it from `src`.
+// Emits the removals (at index `first`) plus SizeChanged on `src`, then the
+// additions (at pos, pos + 1, ...) plus SizeChanged on `dst`, each as one
+// call (see range_events_locked()): copyable T is copied into per-element
+// events while the container has observers, so they can apply (or undo) the
+// transfer incrementally; otherwise one ranged event without values stands
+// for the range.
+// Throws std::invalid_argument if src and dst are the same container and
+// std::out_of_range unless first <= last <= src.size() and pos <= dst.size().
+template <typename U, template <typename, typename> class C, typename A, typename L, typename P, ChangeTypeMask M>
+void transfer(ObservableContainer<U, C, A, L, P, M>& src, size_t first, size_t last,
+              ObservableContainer<U, C, A, L, P, M>& dst, size_t pos) {
+    if (&src == &dst) {
+        throw std::invalid_argument("transfer() requires distinct containers");
+    }
+    size_t moved = 0;
+    std::vector<ChangeEvent<U>> removed;
+    std::vector<ChangeEvent<U>> added;
+    {
+        std::scoped_lock lock(src.mutex_, dst.mutex_);
+        if (first > last || last > src.data_.size() || pos > dst.data_.size()) {
+            throw std::out_of_range("transfer() bounds out of range");
+        }
+        moved = last - first;
+        if (moved == 0) {
+            return;
+        }
+        auto src_first = src.data_.begin();
+        std::advance(src_first, first);
+        auto src_last = src_first;
+        std::advance(src_last, moved);
+        auto dst_pos = dst.data_.begin();
+        std::advance(dst_pos, pos);
+
+        bool spliced = false;
+        if constexpr (ObservableContainerHelpers::IsStdList<C<U, A>>::value) {
+            if (src.data_.get_allocator() == dst.data_.get_allocator()) {
+                dst.data_.splice(dst_pos, src.data_, src_first, src_last);
+                spliced = true;
+            }
+        }
+        if (!spliced) {
+            dst.data_.insert(dst_pos, std::make_move_iterator(src_first), std::make_move_iterator(src_last));
+            src.data_.erase(src_first, src_last);
+        }
+        src.template note_change_locked<ChangeType::ElementRemoved, ChangeType::SizeChanged>();
+        dst.template note_change_locked<ChangeType::ElementAdded, ChangeType::SizeChanged>();
+        // The moved elements now sit at `pos` in dst.
+        const auto values = std::next(dst.data_.cbegin(), static_cast<std::ptrdiff_t>(pos));
+        removed = src.range_events_locked(ChangeType::ElementRemoved, first, moved, values);
+        added = dst.range_events_locked(ChangeType::ElementAdded, pos, moved, values);
+    }
+    src.notify_recorded(removed);
+    dst.notify_recorded(added);
+}
+
 #endif // OBSERVABLE_CONTAINER_H
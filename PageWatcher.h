@@ -0,0 +1,132 @@
+#ifndef PAGE_WATCHER_H
+#define PAGE_WATCHER_H
+
+#include <algorithm>  // Required for std::max
+#include <cstddef>    // Required for size_t
+#include <functional> // Required for std::function
+#include <mutex>      // Required for std::mutex, std::lock_guard
+#include <stdexcept>  // Required for std::invalid_argument
+#include <utility>    // Required for std::move
+#include <vector>     // Required for std::vector
+#include "ChangeEvent.h"
+#include "DirtyRangeTracker.h"
+
+// Page-level change subscription for paged consumers (UI viewports, RPC
+// clients) that re-read pages with read_page().
+//
+// The container is split into pages of `pageSize` positions. Each event is
+// mapped to the pages whose contents it changed (DirtyRangeTracker), and
+// those pages are marked dirty until takeDirtyPages() collects them. An
+// insertion or removal dirties every page from its position to the end,
+// since later elements shift. Events without detail (BatchUpdate) dirty all
+// pages.
+//
+// The optional callback receives the range of pages [first, last) an event
+// dirtied, but only if at least one of them was clean, so a consumer gets
+// one wake-up per page between two takeDirtyPages() calls rather than one
+// per element event. It runs on the writer's thread, outside the watcher's
+// lock.
+template <typename Container>
+class PageWatcher {
+public:
+    using value_type = typename Container::value_type;
+    using Callback = std::function<void(IndexRange pages)>;
+
+    PageWatcher(Container& source, size_t pageSize, Callback onDirty = Callback())
+        : source_(source), page_size_(pageSize), on_dirty_(std::move(onDirty)), tracker_(source.size()) {
+        if (page_size_ == 0) {
+            throw std::invalid_argument("PageWatcher page size must be positive");
+        }
+        handle_ = source_.addObserver([this](const ChangeEvent<value_type>& event) { onChange(event); });
+    }
+
+    ~PageWatcher() {
+        source_.removeObserver(handle_);
+    }
+
+    PageWatcher(const PageWatcher&) = delete;
+    PageWatcher& operator=(const PageWatcher&) = delete;
+
+    size_t pageSize() const noexcept { return page_size_; }
+
+    // Number of pages for the container size seen through events.
+    size_t pageCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return pagesFor(tracker_.size());
+    }
+
+    bool isDirty(size_t page) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return page < dirty_.size() && dirty_[page];
+    }
+
+    // Returns the dirty pages in ascending order and marks them clean. Pages
+    // past the current end are included when a removal emptied them.
+    std::vector<size_t> takeDirtyPages() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<size_t> pages;
+        for (size_t page = 0; page < dirty_.size(); ++page) {
+            if (dirty_[page]) {
+                pages.push_back(page);
+            }
+        }
+        dirty_.assign(dirty_.size(), false);
+        return pages;
+    }
+
+private:
+    void onChange(const ChangeEvent<value_type>& event) {
+        IndexRange newly_dirty;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            const size_t old_size = tracker_.size();
+            auto range = tracker_.apply(event);
+            if (event.type == ChangeType::BatchUpdate) {
+                // As in Checkpointer: the container lock is not held during
+                // dispatch, so size() is safe.
+                tracker_.resync(source_.size());
+            }
+            if (!range || range->empty()) {
+                return;
+            }
+            if (range->last == DirtyRangeTracker::Unbounded) {
+                range = IndexRange{0, std::max(old_size, tracker_.size())};
+                if (range->empty()) {
+                    return;
+                }
+            }
+            newly_dirty = markDirty(range->first / page_size_, (range->last - 1) / page_size_ + 1);
+        }
+        if (on_dirty_ && !newly_dirty.empty()) {
+            on_dirty_(newly_dirty);
+        }
+    }
+
+    // Marks pages [first, last) dirty; returns them if any was clean.
+    IndexRange markDirty(size_t first, size_t last) {
+        if (dirty_.size() < last) {
+            dirty_.resize(last, false);
+        }
+        bool any_clean = false;
+        for (size_t page = first; page < last; ++page) {
+            any_clean = any_clean || !dirty_[page];
+            dirty_[page] = true;
+        }
+        return any_clean ? IndexRange{first, last} : IndexRange{};
+    }
+
+    size_t pagesFor(size_t elements) const {
+        return (elements + page_size_ - 1) / page_size_;
+    }
+
+    Container& source_;
+    const size_t page_size_;
+    Callback on_dirty_;
+    typename Container::ObserverHandle handle_ = 0;
+
+    mutable std::mutex mutex_; // Guards tracker_ and dirty_
+    DirtyRangeTracker tracker_;
+    std::vector<bool> dirty_;
+};
+
+#endif // PAGE_WATCHER_H
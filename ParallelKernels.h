@@ -0,0 +1,237 @@
+#ifndef PARALLEL_KERNELS_H
+#define PARALLEL_KERNELS_H
+
+#include <algorithm>          // Required for std::min
+#include <atomic>             // Required for std::atomic
+#include <condition_variable> // Required for std::condition_variable
+#include <cstddef>            // Required for size_t
+#include <cstdint>            // Required for uint64_t
+#include <exception>          // Required for std::exception_ptr
+#include <limits>             // Required for std::numeric_limits
+#include <memory>             // Required for std::make_shared
+#include <mutex>              // Required for std::mutex, std::unique_lock
+#include <optional>           // Required for std::optional
+#include <type_traits>        // Required for std::is_arithmetic_v
+#include <vector>             // Required for std::vector
+#include "ThreadPool.h"
+
+// How a container-level search (find_if, count_if, min_element, ...) runs.
+// Auto goes parallel for random-access containers of at least
+// ParallelKernels::ParallelThreshold elements when the pool has more than
+// one worker.
+enum class ExecutionPolicy {
+    Sequential,
+    Parallel,
+    Auto
+};
+
+// Result of a positional search: the index (if any) and the container
+// version it refers to. The index is valid while version() still returns
+// `version`.
+struct SearchResult {
+    std::optional<size_t> index;
+    uint64_t version = 0;
+};
+
+// Search kernels over a random-access range [first, first + n), used by
+// ObservableContainer while it holds its lock.
+//
+// Inner loops run over fixed-size blocks with no early exit inside a block:
+// the block is reduced first (first match, match count, block minimum) and
+// only then inspected, a shape compilers turn into SIMD code for arithmetic
+// element types, and which becomes a plain pointer loop for std::vector.
+//
+// Parallel runs split the range into chunks. Pool workers and the calling
+// thread claim chunks from a shared counter, and the caller waits for the
+// chunks to complete rather than for the pool tasks to start, so a kernel
+// invoked from inside a pool task cannot deadlock the pool.
+namespace ParallelKernels {
+    constexpr size_t Block = 64;
+    constexpr size_t ParallelThreshold = size_t(1) << 15;
+    constexpr size_t MinChunk = size_t(1) << 12;
+    constexpr size_t NotFound = std::numeric_limits<size_t>::max();
+
+    inline bool goParallel(ExecutionPolicy policy, size_t n, const ThreadPool& pool) {
+        switch (policy) {
+            case ExecutionPolicy::Sequential: return false;
+            case ExecutionPolicy::Parallel:   return n >= 2 * MinChunk;
+            case ExecutionPolicy::Auto:       return n >= ParallelThreshold && pool.size() > 1;
+        }
+        return false;
+    }
+
+    // Runs fn(chunk, begin, end) for every chunk of [0, n) on the pool and
+    // the calling thread; rethrows the first exception from fn.
+    template <typename Fn>
+    void forEachChunk(ThreadPool& pool, size_t n, size_t chunks, Fn fn) {
+        struct State {
+            std::atomic<size_t> next{0};
+            size_t done = 0;
+            std::exception_ptr error;
+            std::mutex mutex;
+            std::condition_variable cv;
+        };
+        auto state = std::make_shared<State>();
+        const size_t chunk_size = (n + chunks - 1) / chunks;
+        // Claims and runs chunks until none are left. `fn` lives on the
+        // caller's stack, which outlives every claimed chunk.
+        auto work = [state, chunks, chunk_size, n, &fn] {
+            size_t chunk;
+            while ((chunk = state->next.fetch_add(1)) < chunks) {
+                std::exception_ptr error;
+                try {
+                    const size_t begin = std::min(chunk * chunk_size, n);
+                    fn(chunk, begin, std::min(begin + chunk_size, n));
+                } catch (...) {
+                    error = std::current_exception();
+                }
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (error && !state->error) {
+                    state->error = error;
+                }
+                if (++state->done == chunks) {
+                    state->cv.notify_all();
+                }
+            }
+        };
+        const size_t helpers = std::min(pool.size(), chunks - 1);
+        for (size_t i = 0; i < helpers; ++i) {
+            // A helper that starts after all chunks are claimed returns
+            // without touching `fn`.
+            pool.submit([state, chunks, work] {
+                if (state->next.load() < chunks) {
+                    work();
+                }
+            });
+        }
+        work();
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->cv.wait(lock, [&] { return state->done == chunks; });
+        if (state->error) {
+            std::rethrow_exception(state->error);
+        }
+    }
+
+    inline size_t chunkCount(size_t n, const ThreadPool& pool) {
+        return std::max<size_t>(1, std::min(pool.size() * 4, n / MinChunk));
+    }
+
+    // Index of the first element in [begin, end) satisfying pred, or
+    // NotFound. pred runs at most once per element and never past the
+    // match. Stops early once `bound` (a match found by another chunk)
+    // drops below the current block.
+    template <typename It, typename Pred>
+    size_t findInRange(It first, size_t begin, size_t end, Pred& pred, const std::atomic<size_t>* bound) {
+        for (size_t block = begin; block < end; block += Block) {
+            if (bound && bound->load(std::memory_order_relaxed) < block) {
+                return NotFound;
+            }
+            const size_t block_end = std::min(block + Block, end);
+            size_t hit = NotFound;
+            for (size_t i = block; i < block_end; ++i) {
+                if (hit == NotFound && pred(first[i])) {
+                    hit = i;
+                }
+            }
+            if (hit != NotFound) {
+                return hit;
+            }
+        }
+        return NotFound;
+    }
+
+    template <typename It, typename Pred>
+    size_t countInRange(It first, size_t begin, size_t end, Pred& pred) {
+        size_t count = 0;
+        for (size_t i = begin; i < end; ++i) {
+            count += pred(first[i]) ? 1 : 0;
+        }
+        return count;
+    }
+
+    // Index of the first minimum of [begin, end) under compare, or NotFound
+    // if the range is empty. For arithmetic elements, blocks are reduced to
+    // their minimum value before the winning block is scanned for its
+    // position.
+    template <typename It, typename Compare>
+    size_t minInRange(It first, size_t begin, size_t end, Compare& compare) {
+        if (begin >= end) {
+            return NotFound;
+        }
+        size_t best = begin;
+        if constexpr (!std::is_arithmetic_v<std::decay_t<decltype(first[0])>>) {
+            // Block minima would copy elements; compare in place instead.
+            for (size_t i = begin + 1; i < end; ++i) {
+                if (compare(first[i], first[best])) {
+                    best = i;
+                }
+            }
+            return best;
+        }
+        for (size_t block = begin; block < end; block += Block) {
+            const size_t block_end = std::min(block + Block, end);
+            auto block_min = first[block];
+            for (size_t i = block + 1; i < block_end; ++i) {
+                block_min = compare(first[i], block_min) ? first[i] : block_min;
+            }
+            if (compare(block_min, first[best])) {
+                for (size_t i = block; i < block_end; ++i) {
+                    if (!compare(block_min, first[i]) && !compare(first[i], block_min)) {
+                        best = i;
+                        break;
+                    }
+                }
+            }
+        }
+        return best;
+    }
+
+    template <typename It, typename Pred>
+    size_t findFirst(It first, size_t n, Pred pred, ExecutionPolicy policy, ThreadPool& pool) {
+        if (!goParallel(policy, n, pool)) {
+            return findInRange(first, 0, n, pred, nullptr);
+        }
+        std::atomic<size_t> found{NotFound};
+        forEachChunk(pool, n, chunkCount(n, pool), [&](size_t, size_t begin, size_t end) {
+            const size_t index = findInRange(first, begin, end, pred, &found);
+            size_t current = found.load();
+            while (index < current && !found.compare_exchange_weak(current, index)) {
+            }
+        });
+        return found.load();
+    }
+
+    template <typename It, typename Pred>
+    size_t countMatches(It first, size_t n, Pred pred, ExecutionPolicy policy, ThreadPool& pool) {
+        if (!goParallel(policy, n, pool)) {
+            return countInRange(first, 0, n, pred);
+        }
+        std::atomic<size_t> total{0};
+        forEachChunk(pool, n, chunkCount(n, pool), [&](size_t, size_t begin, size_t end) {
+            total.fetch_add(countInRange(first, begin, end, pred), std::memory_order_relaxed);
+        });
+        return total.load();
+    }
+
+    template <typename It, typename Compare>
+    size_t findMin(It first, size_t n, Compare compare, ExecutionPolicy policy, ThreadPool& pool) {
+        if (!goParallel(policy, n, pool)) {
+            return minInRange(first, 0, n, compare);
+        }
+        const size_t chunks = chunkCount(n, pool);
+        std::vector<size_t> winners(chunks, NotFound);
+        forEachChunk(pool, n, chunks, [&](size_t chunk, size_t begin, size_t end) {
+            winners[chunk] = minInRange(first, begin, end, compare);
+        });
+        // Chunks are in index order, so a strict comparison keeps the first minimum.
+        size_t best = NotFound;
+        for (size_t index : winners) {
+            if (index != NotFound && (best == NotFound || compare(first[index], first[best]))) {
+                best = index;
+            }
+        }
+        return best;
+    }
+} // namespace ParallelKernels
+
+#endif // PARALLEL_KERNELS_H
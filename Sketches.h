@@ -0,0 +1,389 @@
+#ifndef SKETCHES_H
+#define SKETCHES_H
+
+#include <algorithm>   // Required for std::max, std::min
+#include <cmath>       // Required for std::log, std::pow, std::ceil
+#include <cstdint>     // Required for uint32_t, uint64_t
+#include <cstdlib>     // Required for std::labs
+#include <functional>  // Required for std::hash
+#include <iterator>    // Required for std::prev
+#include <map>         // Required for std::map
+#include <mutex>       // Required for std::mutex, std::lock_guard
+#include <stdexcept>   // Required for std::invalid_argument
+#include <utility>     // Required for std::pair, std::move
+#include <vector>      // Required for std::vector
+#include "ChangeEvent.h"
+
+// Streaming summaries of container contents that support deletion, so they
+// can follow ElementRemoved/ElementModified events instead of being rebuilt.
+
+// Deletable relative-error quantile sketch (DDSketch-style log buckets).
+//
+// Every value maps deterministically to a bucket whose bounds are within
+// `relativeAccuracy` of each other, so removing a value decrements exactly
+// the bucket its insertion incremented. Quantile estimates are within
+// `relativeAccuracy` of a true value at that rank (values with magnitude
+// below `minIndexable` collapse to 0).
+//
+// Quantiles listed in `trackedQuantiles` keep a cursor on the bucket that
+// holds their rank. Only non-empty buckets are stored, and each
+// insert/remove moves the rank by at most one, so a cursor steps over at
+// most a couple of them: updates cost O(log non-empty buckets) however far
+// apart the values are, and tracked(i) is O(1). quantile(q) for an arbitrary
+// q scans the non-empty buckets.
+class QuantileSketch {
+public:
+    explicit QuantileSketch(double relativeAccuracy = 0.01,
+                            std::vector<double> trackedQuantiles = {0.5, 0.9, 0.99},
+                            double minIndexable = 1e-9)
+        : gamma_((1 + relativeAccuracy) / (1 - relativeAccuracy)),
+          log_gamma_(std::log(gamma_)),
+          min_indexable_(minIndexable) {
+        if (!(relativeAccuracy > 0 && relativeAccuracy < 1) || !(minIndexable > 0)) {
+            throw std::invalid_argument("QuantileSketch accuracy must be in (0, 1)");
+        }
+        min_exponent_ = static_cast<long>(std::ceil(std::log(min_indexable_) / log_gamma_));
+        for (double q : trackedQuantiles) {
+            if (q < 0 || q > 1) {
+                throw std::invalid_argument("Quantiles must be in [0, 1]");
+            }
+            cursors_.push_back(Cursor{q, 0, 0});
+        }
+    }
+
+    void add(double value) {
+        const long key = keyFor(value);
+        counts_[key] += 1;
+        ++count_;
+        for (Cursor& cursor : cursors_) {
+            if (count_ == 1) {
+                cursor.key = key;
+                cursor.below = 0;
+            } else if (key < cursor.key) {
+                ++cursor.below;
+            }
+            settle(cursor);
+        }
+    }
+
+    // Returns false (and changes nothing) if no value maps to that bucket.
+    bool remove(double value) {
+        const auto it = counts_.find(keyFor(value));
+        if (it == counts_.end()) {
+            return false;
+        }
+        const long key = it->first;
+        if (--it->second == 0) {
+            counts_.erase(it);
+        }
+        --count_;
+        for (Cursor& cursor : cursors_) {
+            if (key < cursor.key) {
+                --cursor.below;
+            }
+            if (count_ > 0) {
+                settle(cursor);
+            }
+        }
+        return true;
+    }
+
+    void clear() {
+        counts_.clear();
+        count_ = 0;
+        for (Cursor& cursor : cursors_) {
+            cursor.key = 0;
+            cursor.below = 0;
+        }
+    }
+
+    // Adds every value of `other`, which must use the same accuracy.
+    void merge(const QuantileSketch& other) {
+        if (other.gamma_ != gamma_ || other.min_indexable_ != min_indexable_) {
+            throw std::invalid_argument("Cannot merge sketches with different parameters");
+        }
+        for (const auto& [key, n] : other.counts_) {
+            counts_[key] += n;
+        }
+        count_ += other.count_;
+        for (Cursor& cursor : cursors_) {
+            cursor.key = counts_.empty() ? 0 : counts_.begin()->first;
+            cursor.below = 0;
+            if (count_ > 0) {
+                settle(cursor);
+            }
+        }
+    }
+
+    uint64_t count() const noexcept { return count_; }
+    bool empty() const noexcept { return count_ == 0; }
+
+    // O(1) estimate for the i-th tracked quantile; NaN when empty.
+    double tracked(size_t i) const {
+        return count_ == 0 ? std::nan("") : valueFor(cursors_.at(i).key);
+    }
+
+    // Estimate for any quantile; O(number of non-empty buckets).
+    double quantile(double q) const {
+        if (count_ == 0) {
+            return std::nan("");
+        }
+        const uint64_t rank = rankFor(q);
+        uint64_t below = 0;
+        for (const auto& [key, n] : counts_) {
+            below += n;
+            if (rank < below) {
+                return valueFor(key);
+            }
+        }
+        return valueFor(counts_.rbegin()->first);
+    }
+
+private:
+    struct Cursor {
+        double quantile;
+        long key;       // Bucket holding the quantile's rank
+        uint64_t below; // Values in buckets below `key`
+    };
+
+    // Monotone bucket key: 0 for |value| < minIndexable, positive above,
+    // mirrored negative below.
+    long keyFor(double value) const {
+        if (std::abs(value) < min_indexable_) {
+            return 0;
+        }
+        const long key = static_cast<long>(std::ceil(std::log(std::abs(value)) / log_gamma_)) - min_exponent_ + 1;
+        return value > 0 ? key : -key;
+    }
+
+    double valueFor(long key) const {
+        if (key == 0) {
+            return 0;
+        }
+        const long exponent = std::labs(key) + min_exponent_ - 1;
+        const double magnitude = 2 * std::pow(gamma_, static_cast<double>(exponent)) / (gamma_ + 1);
+        return key > 0 ? magnitude : -magnitude;
+    }
+
+    uint64_t rankFor(double q) const {
+        return static_cast<uint64_t>(q * static_cast<double>(count_ - 1));
+    }
+
+    uint64_t countAt(long key) const {
+        const auto it = counts_.find(key);
+        return it == counts_.end() ? 0 : it->second;
+    }
+
+    // Restores below <= rank < below + count(key), stepping between
+    // non-empty buckets only. `key` may name a bucket that has just emptied.
+    void settle(Cursor& cursor) {
+        const uint64_t rank = rankFor(cursor.quantile);
+        while (rank < cursor.below) {
+            const auto lower = std::prev(counts_.lower_bound(cursor.key));
+            cursor.key = lower->first;
+            cursor.below -= lower->second;
+        }
+        while (rank >= cursor.below + countAt(cursor.key)) {
+            cursor.below += countAt(cursor.key);
+            cursor.key = counts_.upper_bound(cursor.key)->first;
+        }
+    }
+
+    double gamma_;
+    double log_gamma_;
+    double min_indexable_;
+    long min_exponent_ = 0;
+    std::map<long, uint64_t> counts_; // Non-empty buckets by key
+    uint64_t count_ = 0;
+    std::vector<Cursor> cursors_;
+};
+
+// Deletable HyperLogLog (counting HLL) distinct-count estimator.
+//
+// Each of the 2^Precision registers keeps a count per leading-zero rank
+// instead of only the maximum, so remove() can lower a register again once
+// the last value with its maximal rank is gone. The harmonic sum and the
+// number of empty registers are maintained incrementally, making estimate()
+// O(1). Standard error is about 1.04 / sqrt(2^Precision).
+template <typename T, unsigned Precision = 10, typename Hash = std::hash<T>>
+class CardinalitySketch {
+    static_assert(Precision >= 4 && Precision <= 16, "Precision must be in [4, 16]");
+
+public:
+    static constexpr size_t RegisterCount = size_t(1) << Precision;
+    static constexpr unsigned MaxRank = 64 - Precision + 1;
+
+    CardinalitySketch() : counts_(RegisterCount * MaxRank, 0), registers_(RegisterCount, 0) {}
+
+    void add(const T& value) {
+        const auto [reg, rank] = locate(value);
+        ++counts_[reg * MaxRank + rank - 1];
+        if (rank > registers_[reg]) {
+            setRegister(reg, rank);
+        }
+    }
+
+    // Returns false if no added value has the same register and rank.
+    bool remove(const T& value) {
+        const auto [reg, rank] = locate(value);
+        uint32_t& slot = counts_[reg * MaxRank + rank - 1];
+        if (slot == 0) {
+            return false;
+        }
+        if (--slot == 0 && rank == registers_[reg]) {
+            unsigned lower = rank - 1;
+            while (lower > 0 && counts_[reg * MaxRank + lower - 1] == 0) {
+                --lower;
+            }
+            setRegister(reg, lower);
+        }
+        return true;
+    }
+
+    void clear() {
+        std::fill(counts_.begin(), counts_.end(), 0);
+        std::fill(registers_.begin(), registers_.end(), 0);
+        inverse_sum_ = static_cast<double>(RegisterCount);
+        empty_registers_ = RegisterCount;
+    }
+
+    void merge(const CardinalitySketch& other) {
+        for (size_t reg = 0; reg < RegisterCount; ++reg) {
+            for (unsigned rank = 1; rank <= MaxRank; ++rank) {
+                counts_[reg * MaxRank + rank - 1] += other.counts_[reg * MaxRank + rank - 1];
+            }
+            if (other.registers_[reg] > registers_[reg]) {
+                setRegister(reg, other.registers_[reg]);
+            }
+        }
+    }
+
+    // O(1) estimate of the number of distinct values currently present.
+    double estimate() const {
+        const double m = static_cast<double>(RegisterCount);
+        const double alpha = 0.7213 / (1 + 1.079 / m);
+        const double raw = alpha * m * m / inverse_sum_;
+        if (raw <= 2.5 * m && empty_registers_ > 0) {
+            return m * std::log(m / static_cast<double>(empty_registers_)); // Linear counting
+        }
+        return raw;
+    }
+
+private:
+    std::pair<size_t, unsigned> locate(const T& value) const {
+        // splitmix64 finalizer: std::hash is the identity for integers.
+        uint64_t h = static_cast<uint64_t>(Hash{}(value)) + 0x9E3779B97F4A7C15ull;
+        h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+        h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+        h ^= h >> 31;
+        const size_t reg = static_cast<size_t>(h >> (64 - Precision));
+        const uint64_t rest = h << Precision;
+        const unsigned rank = rest == 0 ? MaxRank : static_cast<unsigned>(__builtin_clzll(rest)) + 1;
+        return {reg, std::min(rank, MaxRank)};
+    }
+
+    void setRegister(size_t reg, unsigned rank) {
+        const unsigned old_rank = registers_[reg];
+        inverse_sum_ += std::ldexp(1.0, -static_cast<int>(rank)) - std::ldexp(1.0, -static_cast<int>(old_rank));
+        if (old_rank == 0) --empty_registers_;
+        if (rank == 0) ++empty_registers_;
+        registers_[reg] = static_cast<uint8_t>(rank);
+    }
+
+    std::vector<uint32_t> counts_;  // Per register, count of values per rank
+    std::vector<uint8_t> registers_; // Current maximum rank per register
+    double inverse_sum_ = static_cast<double>(RegisterCount); // Sum of 2^-register
+    size_t empty_registers_ = RegisterCount;
+};
+
+// Keeps a sketch in step with an ObservableContainer. The sketch needs
+// add(value), remove(value) and clear(). Added/removed/modified values update
+// it incrementally; BatchUpdate, value-less events and size changes the
+// element events did not account for (clear()) rebuild it from the container
+// (structural writers must be quiescent during that rebuild, as for
+// Checkpointer).
+template <typename Container, typename Sketch>
+class SketchObserver {
+public:
+    using value_type = typename Container::value_type;
+
+    explicit SketchObserver(Container& source, Sketch sketch = Sketch())
+        : source_(source), sketch_(std::move(sketch)) {
+        rebuild();
+        handle_ = source_.addObserver([this](const ChangeEvent<value_type>& event) { onChange(event); });
+    }
+
+    ~SketchObserver() {
+        source_.removeObserver(handle_);
+    }
+
+    SketchObserver(const SketchObserver&) = delete;
+    SketchObserver& operator=(const SketchObserver&) = delete;
+
+    // Runs fn(const Sketch&) under the observer's lock and returns its result.
+    template <typename Fn>
+    auto withSketch(Fn&& fn) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return fn(static_cast<const Sketch&>(sketch_));
+    }
+
+private:
+    void onChange(const ChangeEvent<value_type>& event) {
+        switch (event.type) {
+            case ChangeType::SizeChanged: {
+                std::unique_lock<std::mutex> lock(mutex_);
+                if (!event.newSize || *event.newSize == size_) {
+                    return;
+                }
+                break;
+            }
+            case ChangeType::ElementAdded:
+                if (event.newValue && !event.count) {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    sketch_.add(*event.newValue);
+                    ++size_;
+                    return;
+                }
+                break;
+            case ChangeType::ElementRemoved:
+                if (event.oldValue && !event.count) {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    sketch_.remove(*event.oldValue);
+                    --size_;
+                    return;
+                }
+                break;
+            case ChangeType::ElementModified:
+                if (event.oldValue && event.newValue && !event.count) {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    sketch_.remove(*event.oldValue);
+                    sketch_.add(*event.newValue);
+                    return;
+                }
+                break;
+            case ChangeType::Permuted:
+                return; // Same values, new positions
+            default:
+                break;
+        }
+        rebuild();
+    }
+
+    void rebuild() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sketch_.clear();
+        size_ = 0;
+        for (auto it = source_.cbegin(); it != source_.cend(); ++it) {
+            sketch_.add(*it);
+            ++size_;
+        }
+    }
+
+    Container& source_;
+    mutable std::mutex mutex_; // Guards sketch_ and size_
+    Sketch sketch_;
+    size_t size_ = 0; // Element count the sketch reflects
+    typename Container::ObserverHandle handle_ = 0;
+};
+
+#endif // SKETCHES_H
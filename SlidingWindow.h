@@ -0,0 +1,219 @@
+#ifndef SLIDING_WINDOW_H
+#define SLIDING_WINDOW_H
+
+#include <algorithm>   // Required for std::max
+#include <chrono>      // Required for std::chrono::steady_clock
+#include <cstddef>     // Required for size_t
+#include <cstdint>     // Required for int64_t
+#include <mutex>       // Required for std::mutex, std::lock_guard
+#include <optional>    // Required for std::optional
+#include <stdexcept>   // Required for std::invalid_argument
+#include <utility>     // Required for std::move
+#include <vector>      // Required for std::vector
+#include "ChangeEvent.h"
+
+// Window aggregators for SlidingWindow. An aggregator defines `State` and
+// identity() / lift(value) / combine(a, b), where combine is associative and
+// identity() is its neutral element. No inverse is needed, so max and min
+// work as well as sums.
+struct WindowCount {
+    using State = size_t;
+
+    State identity() const { return 0; }
+
+    template <typename T>
+    State lift(const T&) const { return 1; }
+
+    State combine(State a, State b) const { return a + b; }
+};
+
+// Sum of projection(value), accumulated as `Sum`.
+template <typename Projection, typename Sum = double>
+struct WindowSum {
+    using State = Sum;
+    Projection projection;
+
+    State identity() const { return Sum{}; }
+
+    template <typename T>
+    State lift(const T& value) const { return static_cast<Sum>(projection(value)); }
+
+    State combine(const State& a, const State& b) const { return a + b; }
+};
+
+// Largest projection(value); empty while the window has no samples.
+template <typename Projection, typename Value>
+struct WindowMax {
+    using State = std::optional<Value>;
+    Projection projection;
+
+    State identity() const { return std::nullopt; }
+
+    template <typename T>
+    State lift(const T& value) const { return static_cast<Value>(projection(value)); }
+
+    State combine(const State& a, const State& b) const {
+        if (!a) return b;
+        if (!b) return a;
+        return std::max(*a, *b);
+    }
+};
+
+template <typename Sum = double, typename Projection>
+WindowSum<Projection, Sum> windowSum(Projection projection) {
+    return WindowSum<Projection, Sum>{std::move(projection)};
+}
+
+template <typename Value, typename Projection>
+WindowMax<Projection, Value> windowMax(Projection projection) {
+    return WindowMax<Projection, Value>{std::move(projection)};
+}
+
+// Aggregate over the samples a container received during the last `window`
+// of time. A sample is the value of an ElementAdded event or the new value of
+// an ElementModified event, stamped with clock.now() when the event arrives.
+// Removals do not retract samples: the window describes what was written,
+// not what is currently stored. Ranged events carry no values and are not
+// sampled.
+//
+// The window is split into `panes` equal panes. Each non-empty pane holds one
+// sub-aggregate, and the panes sit in a two-stack queue: new panes are pushed
+// onto a back stack with a running aggregate, and the front stack stores
+// suffix aggregates so that the oldest pane is evicted in O(1) (amortized
+// over the panes flipped from back to front). A sample costs O(1) amortized,
+// and value() combines at most three states without scanning.
+//
+// Expiry has pane granularity: a sample counts while its pane is one of the
+// last `panes` panes, i.e. it expires between window - window / panes and
+// window after it arrived.
+//
+// Clock is any type with a `time_point` typedef and a now() member, e.g.
+// std::chrono::steady_clock (the default) or a manual clock in tests.
+template <typename Container, typename Aggregator = WindowCount, typename Clock = std::chrono::steady_clock>
+class SlidingWindow {
+public:
+    using value_type = typename Container::value_type;
+    using State = typename Aggregator::State;
+    using duration = std::chrono::nanoseconds;
+
+    SlidingWindow(Container& source, duration window, size_t panes = 10,
+                  Aggregator aggregator = Aggregator(), Clock clock = Clock())
+        : source_(source), aggregator_(std::move(aggregator)), clock_(std::move(clock)),
+          pane_width_(panes == 0 ? duration::zero() : window / static_cast<int64_t>(panes)),
+          panes_(static_cast<int64_t>(panes)) {
+        if (pane_width_ <= duration::zero()) {
+            throw std::invalid_argument("SlidingWindow needs a positive window of at least one nanosecond per pane");
+        }
+        back_agg_ = aggregator_.identity();
+        current_ = aggregator_.identity();
+        current_pane_ = paneAt(clock_.now());
+        handle_ = source_.addObserver([this](const ChangeEvent<value_type>& event) { onChange(event); });
+    }
+
+    ~SlidingWindow() {
+        source_.removeObserver(handle_);
+    }
+
+    SlidingWindow(const SlidingWindow&) = delete;
+    SlidingWindow& operator=(const SlidingWindow&) = delete;
+
+    // Aggregate of the samples still in the window at clock.now().
+    State value() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        advance(paneAt(clock_.now()));
+        State front = front_.empty() ? aggregator_.identity() : front_.back().suffix;
+        return aggregator_.combine(aggregator_.combine(front, back_agg_), current_);
+    }
+
+    // Adds a sample directly, as if the container had reported it now.
+    void record(const value_type& value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        addSample(value);
+    }
+
+private:
+    struct Pane {
+        int64_t index;
+        State value;
+    };
+
+    struct FrontPane {
+        int64_t index;
+        State suffix; // This pane combined with every newer pane in front_
+    };
+
+    void onChange(const ChangeEvent<value_type>& event) {
+        if (event.count || !event.newValue) {
+            return;
+        }
+        if (event.type == ChangeType::ElementAdded || event.type == ChangeType::ElementModified) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            addSample(*event.newValue);
+        }
+    }
+
+    void addSample(const value_type& value) {
+        advance(paneAt(clock_.now()));
+        current_ = aggregator_.combine(current_, aggregator_.lift(value));
+        current_samples_ = true;
+    }
+
+    int64_t paneAt(typename Clock::time_point now) const {
+        return std::chrono::duration_cast<duration>(now.time_since_epoch()).count() / pane_width_.count();
+    }
+
+    // Closes the current pane if time has moved past it, then evicts panes
+    // that fell out of the window.
+    void advance(int64_t pane) {
+        if (pane > current_pane_) {
+            if (current_samples_) {
+                back_agg_ = aggregator_.combine(back_agg_, current_);
+                back_.push_back(Pane{current_pane_, std::move(current_)});
+            }
+            current_ = aggregator_.identity();
+            current_samples_ = false;
+            current_pane_ = pane;
+        }
+        const int64_t oldest_kept = current_pane_ - panes_ + 1;
+        while (true) {
+            if (front_.empty()) {
+                if (back_.empty() || back_.front().index >= oldest_kept) {
+                    return;
+                }
+                flip();
+            }
+            if (front_.back().index >= oldest_kept) {
+                return;
+            }
+            front_.pop_back();
+        }
+    }
+
+    // Moves every back pane to the front stack, oldest on top.
+    void flip() {
+        State suffix = aggregator_.identity();
+        for (auto it = back_.rbegin(); it != back_.rend(); ++it) {
+            suffix = aggregator_.combine(it->value, suffix);
+            front_.push_back(FrontPane{it->index, suffix});
+        }
+        back_.clear();
+        back_agg_ = aggregator_.identity();
+    }
+
+    Container& source_;
+    Aggregator aggregator_;
+    Clock clock_;
+    const duration pane_width_;
+    const int64_t panes_;
+    typename Container::ObserverHandle handle_ = 0;
+
+    std::mutex mutex_; // Guards the pane state below
+    std::vector<FrontPane> front_; // Oldest pane at back()
+    std::vector<Pane> back_;       // Oldest pane at front()
+    State back_agg_;
+    State current_;                // Open pane, not yet in back_
+    int64_t current_pane_ = 0;
+    bool current_samples_ = false;
+};
+
+#endif // SLIDING_WINDOW_H
@@ -0,0 +1,452 @@
+#ifndef SORTED_VIEW_H
+#define SORTED_VIEW_H
+
+#include <cstddef>   // Required for size_t
+#include <cstdint>   // Required for uint32_t, uint64_t
+#include <limits>    // Required for std::numeric_limits
+#include <mutex>     // Required for std::mutex, std::lock_guard
+#include <stdexcept> // Required for std::out_of_range
+#include <utility>   // Required for std::move, std::pair
+#include <vector>    // Required for std::vector
+#include "ChangeEvent.h"
+#include "ViewObservers.h"
+
+// The container's elements in `Compare` order, maintained from its events in
+// O(log n) per event instead of re-sorting.
+//
+// Every element is one node that sits in two treaps (randomized balanced
+// trees with subtree sizes, i.e. order-statistic trees):
+//   - a positional treap in source order, which finds the node for a source
+//     index and, through parent links, the source index of a node;
+//   - a sorted treap ordered by (value, insertion serial), which gives the
+//     rank of a node and the node at a rank.
+// Together they form the permutation between source indices and sorted
+// ranks: at(rank), sourceIndex(rank) and rankOf(sourceIndex) are O(log n).
+//
+// The view publishes positional events on the sorted order: ElementAdded /
+// ElementRemoved at a rank, ElementModified when a modified element keeps
+// its rank. Container events without values (BatchUpdate, ranged or
+// move-only events, clear()) rebuild the view and publish one BatchUpdate;
+// the rebuild reads the container through its iterators, so structural
+// writers must be quiescent then. Create it with container.sortedView(); the
+// view must not outlive the container.
+template <typename Container, typename Compare>
+class SortedView : public ViewObservers<typename Container::value_type> {
+public:
+    using value_type = typename Container::value_type;
+
+    explicit SortedView(Container& source, Compare compare = Compare())
+        : source_(source), compare_(compare) {
+        rebuildLocked();
+        handle_ = source_.addObserver([this](const ChangeEvent<value_type>& event) { onChange(event); });
+    }
+
+    ~SortedView() {
+        source_.removeObserver(handle_);
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return sizeOf(sorted_root_);
+    }
+
+    bool empty() const { return size() == 0; }
+
+    // Element at sorted position `rank`.
+    value_type at(size_t rank) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return nodes_[sortedAt(checkRank(rank))].value;
+    }
+
+    // Source index of the element at sorted position `rank`.
+    size_t sourceIndex(size_t rank) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return positionOf(sortedAt(checkRank(rank)));
+    }
+
+    // Sorted position of the element at source index `index`.
+    size_t rankOf(size_t index) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (index >= nodes_in_use_) {
+            throw std::out_of_range("SortedView source index out of range");
+        }
+        return rankOfNode(positionalAt(index));
+    }
+
+    // Number of elements ordered before `value` (first rank where it fits).
+    size_t lowerBound(const value_type& value) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t rank = 0;
+        for (Id n = sorted_root_; n != Null;) {
+            if (compare_(nodes_[n].value, value)) {
+                rank += sizeOf(nodes_[n].left) + 1;
+                n = nodes_[n].right;
+            } else {
+                n = nodes_[n].left;
+            }
+        }
+        return rank;
+    }
+
+    // All elements in sorted order.
+    std::vector<value_type> values() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<value_type> out;
+        out.reserve(nodes_in_use_);
+        appendInOrder(sorted_root_, out);
+        return out;
+    }
+
+private:
+    using Id = uint32_t;
+    using Events = std::vector<ChangeEvent<value_type>>;
+    static constexpr Id Null = std::numeric_limits<Id>::max();
+
+    struct Node {
+        value_type value;
+        uint64_t serial;   // Tie-break among equal values
+        uint32_t priority; // Shared by both treaps
+        Id left = Null;    // Sorted treap
+        Id right = Null;
+        uint32_t size = 1;
+        Id pos_left = Null; // Positional treap
+        Id pos_right = Null;
+        Id pos_parent = Null;
+        uint32_t pos_size = 1;
+    };
+
+    void onChange(const ChangeEvent<value_type>& event) {
+        Events events;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!apply(event, events)) {
+                rebuildLocked();
+                events.clear();
+                events.emplace_back(ChangeType::BatchUpdate);
+            }
+        }
+        this->dispatch(events);
+    }
+
+    bool apply(const ChangeEvent<value_type>& event, Events& events) {
+        if (event.type == ChangeType::Permuted) {
+            return event.index && event.permutation && permutePositions(*event.index, *event.permutation);
+        }
+        if (event.count || (!event.index && event.type != ChangeType::SizeChanged)) {
+            return false;
+        }
+        switch (event.type) {
+            case ChangeType::ElementAdded: {
+                if (!event.newValue || *event.index > nodes_in_use_) return false;
+                const Id n = allocate(*event.newValue);
+                insertPositional(n, *event.index);
+                insertSorted(n);
+                events.emplace_back(ChangeType::ElementAdded, rankOfNode(n), std::nullopt, *event.newValue);
+                events.emplace_back(ChangeType::SizeChanged, std::nullopt, std::nullopt, std::nullopt, nodes_in_use_);
+                return true;
+            }
+            case ChangeType::ElementRemoved: {
+                if (*event.index >= nodes_in_use_) return false;
+                const Id n = positionalAt(*event.index);
+                events.emplace_back(ChangeType::ElementRemoved, rankOfNode(n), nodes_[n].value, std::nullopt);
+                eraseSorted(n);
+                erasePositional(*event.index);
+                release(n);
+                events.emplace_back(ChangeType::SizeChanged, std::nullopt, std::nullopt, std::nullopt, nodes_in_use_);
+                return true;
+            }
+            case ChangeType::ElementModified: {
+                if (!event.newValue || *event.index >= nodes_in_use_) return false;
+                const Id n = positionalAt(*event.index);
+                const size_t old_rank = rankOfNode(n);
+                eraseSorted(n);
+                value_type old_value = std::move(nodes_[n].value);
+                nodes_[n].value = *event.newValue;
+                insertSorted(n);
+                const size_t new_rank = rankOfNode(n);
+                if (old_rank == new_rank) {
+                    events.emplace_back(ChangeType::ElementModified, new_rank, std::move(old_value), *event.newValue);
+                } else {
+                    events.emplace_back(ChangeType::ElementRemoved, old_rank, std::move(old_value), std::nullopt);
+                    events.emplace_back(ChangeType::ElementAdded, new_rank, std::nullopt, *event.newValue);
+                }
+                return true;
+            }
+            case ChangeType::SizeChanged:
+                return !event.newSize || *event.newSize == nodes_in_use_;
+            default:
+                return false;
+        }
+    }
+
+    // Reorders source positions for a Permuted event. Values and ranks are
+    // unchanged, so the view publishes nothing; only sourceIndex()/rankOf()
+    // answers move.
+    bool permutePositions(size_t first, const std::vector<size_t>& order) {
+        if (first > nodes_in_use_ || order.size() > nodes_in_use_ - first) {
+            return false;
+        }
+        std::vector<Id> moved(order.size());
+        for (size_t k = 0; k < order.size(); ++k) {
+            moved[k] = positionalAt(first + k);
+        }
+        for (size_t k = 0; k < order.size(); ++k) {
+            erasePositional(first);
+        }
+        for (size_t k = 0; k < order.size(); ++k) {
+            insertPositional(moved[order[k]], first + k);
+        }
+        return true;
+    }
+
+    // --- Node pool -------------------------------------------------------
+
+    Id allocate(const value_type& value) {
+        rng_ ^= rng_ << 13; // xorshift64 priorities
+        rng_ ^= rng_ >> 7;
+        rng_ ^= rng_ << 17;
+        Node node{value, next_serial_++, static_cast<uint32_t>(rng_ >> 32)};
+        ++nodes_in_use_;
+        if (!free_.empty()) {
+            const Id n = free_.back();
+            free_.pop_back();
+            nodes_[n] = std::move(node);
+            return n;
+        }
+        nodes_.push_back(std::move(node));
+        return static_cast<Id>(nodes_.size() - 1);
+    }
+
+    void release(Id n) {
+        free_.push_back(n);
+        --nodes_in_use_;
+    }
+
+    void rebuildLocked() {
+        nodes_.clear();
+        free_.clear();
+        nodes_in_use_ = 0;
+        sorted_root_ = Null;
+        positional_root_ = Null;
+        for (auto it = source_.cbegin(); it != source_.cend(); ++it) {
+            const Id n = allocate(*it);
+            positional_root_ = mergePositional(positional_root_, n);
+            insertSorted(n);
+        }
+        if (positional_root_ != Null) {
+            nodes_[positional_root_].pos_parent = Null;
+        }
+    }
+
+    // --- Sorted treap ----------------------------------------------------
+
+    uint32_t sizeOf(Id n) const { return n == Null ? 0 : nodes_[n].size; }
+
+    bool less(Id a, Id b) const {
+        const Node& x = nodes_[a];
+        const Node& y = nodes_[b];
+        if (compare_(x.value, y.value)) return true;
+        if (compare_(y.value, x.value)) return false;
+        return x.serial < y.serial;
+    }
+
+    void updateSorted(Id n) {
+        nodes_[n].size = 1 + sizeOf(nodes_[n].left) + sizeOf(nodes_[n].right);
+    }
+
+    // Splits `t` into nodes ordered before `key` and the rest.
+    std::pair<Id, Id> splitSorted(Id t, Id key) {
+        if (t == Null) return {Null, Null};
+        if (less(t, key)) {
+            auto [l, r] = splitSorted(nodes_[t].right, key);
+            nodes_[t].right = l;
+            updateSorted(t);
+            return {t, r};
+        }
+        auto [l, r] = splitSorted(nodes_[t].left, key);
+        nodes_[t].left = r;
+        updateSorted(t);
+        return {l, t};
+    }
+
+    Id mergeSorted(Id a, Id b) {
+        if (a == Null) return b;
+        if (b == Null) return a;
+        if (nodes_[a].priority > nodes_[b].priority) {
+            nodes_[a].right = mergeSorted(nodes_[a].right, b);
+            updateSorted(a);
+            return a;
+        }
+        nodes_[b].left = mergeSorted(a, nodes_[b].left);
+        updateSorted(b);
+        return b;
+    }
+
+    void insertSorted(Id n) {
+        nodes_[n].left = nodes_[n].right = Null;
+        nodes_[n].size = 1;
+        auto [l, r] = splitSorted(sorted_root_, n);
+        sorted_root_ = mergeSorted(mergeSorted(l, n), r);
+    }
+
+    void eraseSorted(Id n) {
+        auto [l, rest] = splitSorted(sorted_root_, n);
+        // `rest` starts with n: detach its leftmost node.
+        sorted_root_ = mergeSorted(l, removeLeftmost(rest));
+    }
+
+    Id removeLeftmost(Id t) {
+        if (nodes_[t].left == Null) {
+            return nodes_[t].right;
+        }
+        nodes_[t].left = removeLeftmost(nodes_[t].left);
+        updateSorted(t);
+        return t;
+    }
+
+    size_t rankOfNode(Id n) const {
+        size_t rank = 0;
+        for (Id t = sorted_root_; t != Null;) {
+            if (t == n) {
+                return rank + sizeOf(nodes_[t].left);
+            }
+            if (less(t, n)) {
+                rank += sizeOf(nodes_[t].left) + 1;
+                t = nodes_[t].right;
+            } else {
+                t = nodes_[t].left;
+            }
+        }
+        return rank;
+    }
+
+    Id sortedAt(size_t rank) const {
+        Id t = sorted_root_;
+        while (true) {
+            const size_t left = sizeOf(nodes_[t].left);
+            if (rank < left) {
+                t = nodes_[t].left;
+            } else if (rank == left) {
+                return t;
+            } else {
+                rank -= left + 1;
+                t = nodes_[t].right;
+            }
+        }
+    }
+
+    size_t checkRank(size_t rank) const {
+        if (rank >= nodes_in_use_) {
+            throw std::out_of_range("SortedView rank out of range");
+        }
+        return rank;
+    }
+
+    void appendInOrder(Id n, std::vector<value_type>& out) const {
+        if (n == Null) return;
+        appendInOrder(nodes_[n].left, out);
+        out.push_back(nodes_[n].value);
+        appendInOrder(nodes_[n].right, out);
+    }
+
+    // --- Positional treap ------------------------------------------------
+
+    uint32_t posSizeOf(Id n) const { return n == Null ? 0 : nodes_[n].pos_size; }
+
+    void updatePositional(Id n) {
+        Node& node = nodes_[n];
+        node.pos_size = 1 + posSizeOf(node.pos_left) + posSizeOf(node.pos_right);
+        if (node.pos_left != Null) nodes_[node.pos_left].pos_parent = n;
+        if (node.pos_right != Null) nodes_[node.pos_right].pos_parent = n;
+    }
+
+    // Splits `t` into its first `count` nodes and the rest.
+    std::pair<Id, Id> splitPositional(Id t, size_t count) {
+        if (t == Null) return {Null, Null};
+        const size_t left = posSizeOf(nodes_[t].pos_left);
+        if (count <= left) {
+            auto [l, r] = splitPositional(nodes_[t].pos_left, count);
+            nodes_[t].pos_left = r;
+            updatePositional(t);
+            if (l != Null) nodes_[l].pos_parent = Null;
+            return {l, t};
+        }
+        auto [l, r] = splitPositional(nodes_[t].pos_right, count - left - 1);
+        nodes_[t].pos_right = l;
+        updatePositional(t);
+        if (r != Null) nodes_[r].pos_parent = Null;
+        return {t, r};
+    }
+
+    Id mergePositional(Id a, Id b) {
+        if (a == Null) return b;
+        if (b == Null) return a;
+        if (nodes_[a].priority > nodes_[b].priority) {
+            nodes_[a].pos_right = mergePositional(nodes_[a].pos_right, b);
+            updatePositional(a);
+            return a;
+        }
+        nodes_[b].pos_left = mergePositional(a, nodes_[b].pos_left);
+        updatePositional(b);
+        return b;
+    }
+
+    void insertPositional(Id n, size_t index) {
+        nodes_[n].pos_left = nodes_[n].pos_right = nodes_[n].pos_parent = Null;
+        nodes_[n].pos_size = 1;
+        auto [l, r] = splitPositional(positional_root_, index);
+        positional_root_ = mergePositional(mergePositional(l, n), r);
+        nodes_[positional_root_].pos_parent = Null;
+    }
+
+    void erasePositional(size_t index) {
+        auto [l, rest] = splitPositional(positional_root_, index);
+        auto [removed, r] = splitPositional(rest, 1);
+        (void)removed;
+        positional_root_ = mergePositional(l, r);
+        if (positional_root_ != Null) {
+            nodes_[positional_root_].pos_parent = Null;
+        }
+    }
+
+    Id positionalAt(size_t index) const {
+        Id t = positional_root_;
+        while (true) {
+            const size_t left = posSizeOf(nodes_[t].pos_left);
+            if (index < left) {
+                t = nodes_[t].pos_left;
+            } else if (index == left) {
+                return t;
+            } else {
+                index -= left + 1;
+                t = nodes_[t].pos_right;
+            }
+        }
+    }
+
+    size_t positionOf(Id n) const {
+        size_t position = posSizeOf(nodes_[n].pos_left);
+        for (Id child = n, parent = nodes_[n].pos_parent; parent != Null;
+             child = parent, parent = nodes_[parent].pos_parent) {
+            if (nodes_[parent].pos_right == child) {
+                position += posSizeOf(nodes_[parent].pos_left) + 1;
+            }
+        }
+        return position;
+    }
+
+    Container& source_;
+    Compare compare_;
+    typename Container::ObserverHandle handle_ = 0;
+
+    mutable std::mutex mutex_; // Guards the node pool and both treaps
+    std::vector<Node> nodes_;
+    std::vector<Id> free_;
+    size_t nodes_in_use_ = 0;
+    Id sorted_root_ = Null;
+    Id positional_root_ = Null;
+    uint64_t next_serial_ = 0;
+    uint64_t rng_ = 0x9E3779B97F4A7C15ull;
+};
+
+#endif // SORTED_VIEW_H
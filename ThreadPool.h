@@ -0,0 +1,92 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable> // Required for std::condition_variable
+#include <functional>         // Required for std::function
+#include <future>             // Required for std::future, std::packaged_task
+#include <memory>             // Required for std::make_shared
+#include <mutex>              // Required for std::mutex, std::unique_lock
+#include <queue>              // Required for std::queue
+#include <thread>             // Required for std::thread
+#include <type_traits>        // Required for std::invoke_result_t
+#include <vector>             // Required for std::vector
+
+// Fixed-size worker pool used for background I/O and parallel kernels.
+// Tasks run in FIFO order; the destructor finishes queued tasks, then joins.
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threads = defaultThreadCount()) {
+        if (threads == 0) {
+            threads = 1;
+        }
+        workers_.reserve(threads);
+        for (size_t i = 0; i < threads; ++i) {
+            workers_.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    template <typename F>
+    std::future<std::invoke_result_t<F>> submit(F&& task) {
+        using Result = std::invoke_result_t<F>;
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        std::future<Result> result = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.emplace([packaged] { (*packaged)(); });
+        }
+        cv_.notify_one();
+        return result;
+    }
+
+    size_t size() const noexcept { return workers_.size(); }
+
+    // Process-wide pool for parallel kernels, created on first use.
+    static ThreadPool& shared() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    static size_t defaultThreadCount() noexcept {
+        const unsigned hardware = std::thread::hardware_concurrency();
+        return hardware == 0 ? 1 : hardware;
+    }
+
+private:
+    void workerLoop() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+                if (tasks_.empty()) {
+                    return; // Stopping and drained
+                }
+                task = std::move(tasks_.front());
+                tasks_.pop();
+            }
+            task();
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::queue<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_ = false;
+};
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,221 @@
+#ifndef TOP_K_VIEW_H
+#define TOP_K_VIEW_H
+
+#include <algorithm>  // Required for std::nth_element, std::find
+#include <cstddef>    // Required for size_t
+#include <iterator>   // Required for std::distance, std::prev
+#include <mutex>      // Required for std::mutex, std::lock_guard
+#include <set>        // Required for std::multiset
+#include <stdexcept>  // Required for std::out_of_range
+#include <utility>    // Required for std::move
+#include <vector>     // Required for std::vector
+#include "ChangeEvent.h"
+#include "ViewObservers.h"
+
+// The first `k` elements of a container in `Compare` order (with
+// std::greater, the k largest), maintained from the container's events.
+//
+// Members are kept in an ordered multiset; all other elements go into a
+// second ordered multiset that acts as an indexed heap. Its best element
+// refills the top-K when a member is removed, and any element can be erased
+// from it, which a plain binary heap does not allow. An event on an element
+// outside the top-K costs O(log n) and produces no view events. An event
+// that changes the top-K costs O(log n + k): the published rank is a
+// distance within the multiset, which is linear. Meant for small k, where
+// that walk is cheaper than maintaining an order-statistic tree.
+//
+// The view publishes positional events on its ranked list: ElementAdded /
+// ElementRemoved at a rank, ElementModified when a member changes value but
+// keeps its rank, SizeChanged while fewer than k elements exist. Events from
+// the container that carry no values (BatchUpdate, ranged or move-only
+// events, clear()) rebuild the view; if the result differs it publishes one
+// BatchUpdate. Removal looks members up by value (operator==), so equal
+// elements are interchangeable.
+//
+// Rebuilding reads the container through its iterators; structural writers
+// must be quiescent then, as for Checkpointer. Create it with
+// container.topK(k, compare); the view must not outlive the container.
+template <typename Container, typename Compare>
+class TopKView : public ViewObservers<typename Container::value_type> {
+public:
+    using value_type = typename Container::value_type;
+
+    TopKView(Container& source, size_t k, Compare compare = Compare())
+        : source_(source), k_(k), compare_(compare), top_(compare), rest_(compare) {
+        rebuildLocked();
+        handle_ = source_.addObserver([this](const ChangeEvent<value_type>& event) { onChange(event); });
+    }
+
+    ~TopKView() {
+        source_.removeObserver(handle_);
+    }
+
+    size_t k() const noexcept { return k_; }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return top_.size();
+    }
+
+    bool empty() const { return size() == 0; }
+
+    // Element at `rank` (0 = best). O(k).
+    value_type at(size_t rank) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (rank >= top_.size()) {
+            throw std::out_of_range("TopKView rank out of range");
+        }
+        return *std::next(top_.begin(), static_cast<std::ptrdiff_t>(rank));
+    }
+
+    // The top-K elements, best first.
+    std::vector<value_type> values() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return std::vector<value_type>(top_.begin(), top_.end());
+    }
+
+private:
+    using Set = std::multiset<value_type, Compare>;
+    using Events = std::vector<ChangeEvent<value_type>>;
+
+    void onChange(const ChangeEvent<value_type>& event) {
+        Events events;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            const size_t old_top_size = top_.size();
+            if (!apply(event, events)) {
+                std::vector<value_type> before(top_.begin(), top_.end());
+                rebuildLocked();
+                events.clear();
+                if (!std::equal(before.begin(), before.end(), top_.begin(), top_.end())) {
+                    events.emplace_back(ChangeType::BatchUpdate);
+                }
+            } else if (top_.size() != old_top_size) {
+                events.emplace_back(ChangeType::SizeChanged, std::nullopt, std::nullopt, std::nullopt, top_.size());
+            }
+        }
+        this->dispatch(events);
+    }
+
+    // Applies one element event; false if the view must be rebuilt.
+    bool apply(const ChangeEvent<value_type>& event, Events& events) {
+        if (event.type == ChangeType::Permuted) {
+            return true; // Reordering the container leaves the ranking unchanged
+        }
+        if (event.count) {
+            return false;
+        }
+        switch (event.type) {
+            case ChangeType::ElementAdded:
+                if (!event.newValue) return false;
+                insertValue(*event.newValue, events);
+                ++size_;
+                return true;
+            case ChangeType::ElementRemoved:
+                if (!event.oldValue) return false;
+                removeValue(*event.oldValue, events);
+                --size_;
+                return true;
+            case ChangeType::ElementModified:
+                if (!event.oldValue || !event.newValue) return false;
+                modifyValue(*event.oldValue, *event.newValue, events);
+                return true;
+            case ChangeType::SizeChanged:
+                // Element events keep size_ in step; a mismatch means a
+                // detail-less change such as clear().
+                return !event.newSize || *event.newSize == size_;
+            default:
+                return false;
+        }
+    }
+
+    void insertValue(const value_type& value, Events& events) {
+        if (top_.size() < k_) {
+            auto it = top_.insert(value); // rest_ is empty while the top-K is not full
+            events.emplace_back(ChangeType::ElementAdded, rankOf(it), std::nullopt, value);
+            return;
+        }
+        if (k_ == 0 || !compare_(value, *std::prev(top_.end()))) {
+            rest_.insert(value);
+            return;
+        }
+        // Displaces the current worst member.
+        auto worst = std::prev(top_.end());
+        events.emplace_back(ChangeType::ElementRemoved, k_ - 1, *worst, std::nullopt);
+        rest_.insert(std::move(top_.extract(worst).value()));
+        auto it = top_.insert(value);
+        events.emplace_back(ChangeType::ElementAdded, rankOf(it), std::nullopt, value);
+    }
+
+    void removeValue(const value_type& value, Events& events) {
+        auto it = find(top_, value);
+        if (it == top_.end()) {
+            auto rest_it = find(rest_, value);
+            if (rest_it != rest_.end()) {
+                rest_.erase(rest_it);
+            }
+            return;
+        }
+        events.emplace_back(ChangeType::ElementRemoved, rankOf(it), *it, std::nullopt);
+        top_.erase(it);
+        if (!rest_.empty()) {
+            auto promoted = top_.insert(std::move(rest_.extract(rest_.begin()).value()));
+            events.emplace_back(ChangeType::ElementAdded, rankOf(promoted), std::nullopt, *promoted);
+        }
+    }
+
+    void modifyValue(const value_type& old_value, const value_type& new_value, Events& events) {
+        auto it = find(top_, old_value);
+        // A member whose new value still beats every non-member stays in
+        // the top-K: report a move or an in-place modification.
+        if (it != top_.end() && (rest_.empty() || !compare_(*rest_.begin(), new_value))) {
+            const size_t old_rank = rankOf(it);
+            top_.erase(it);
+            auto inserted = top_.insert(new_value);
+            const size_t new_rank = rankOf(inserted);
+            if (old_rank == new_rank) {
+                events.emplace_back(ChangeType::ElementModified, new_rank, old_value, new_value);
+            } else {
+                events.emplace_back(ChangeType::ElementRemoved, old_rank, old_value, std::nullopt);
+                events.emplace_back(ChangeType::ElementAdded, new_rank, std::nullopt, new_value);
+            }
+            return;
+        }
+        removeValue(old_value, events);
+        insertValue(new_value, events);
+    }
+
+    typename Set::iterator find(Set& set, const value_type& value) {
+        auto [first, last] = set.equal_range(value);
+        auto it = std::find(first, last, value);
+        return it == last ? set.end() : it;
+    }
+
+    // O(k): std::multiset keeps no subtree sizes.
+    size_t rankOf(typename Set::const_iterator it) const {
+        return static_cast<size_t>(std::distance(top_.cbegin(), it));
+    }
+
+    void rebuildLocked() {
+        std::vector<value_type> all(source_.cbegin(), source_.cend());
+        size_ = all.size();
+        top_.clear();
+        rest_.clear();
+        const size_t split = std::min(k_, all.size());
+        std::nth_element(all.begin(), all.begin() + static_cast<std::ptrdiff_t>(split), all.end(), compare_);
+        top_.insert(all.begin(), all.begin() + static_cast<std::ptrdiff_t>(split));
+        rest_.insert(all.begin() + static_cast<std::ptrdiff_t>(split), all.end());
+    }
+
+    Container& source_;
+    const size_t k_;
+    Compare compare_;
+    typename Container::ObserverHandle handle_ = 0;
+
+    mutable std::mutex mutex_; // Guards top_, rest_ and size_
+    Set top_;    // At most k_ members, best first
+    Set rest_;   // Every other element; rest_.begin() is the next candidate
+    size_t size_ = 0; // Source size as seen through events
+};
+
+#endif // TOP_K_VIEW_H
@@ -0,0 +1,81 @@
+#ifndef VALUE_CODEC_H
+#define VALUE_CODEC_H
+
+#include <cstdint>     // Required for uint8_t, uint64_t
+#include <cstring>     // Required for std::memcpy
+#include <stdexcept>   // Required for std::runtime_error
+#include <string>      // Required for std::string
+#include <type_traits> // Required for std::is_trivially_copyable
+#include <vector>      // Required for std::vector
+
+// Byte-level encoding used by packed events, checkpoints, journals and streams.
+using ByteBuffer = std::vector<uint8_t>;
+
+namespace ByteIO {
+    // LEB128 variable-length unsigned integer: small indices/sizes take 1-2 bytes.
+    inline void appendVarint(ByteBuffer& out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    inline uint64_t readVarint(const uint8_t*& cursor, const uint8_t* end) {
+        uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            if (cursor == end) throw std::runtime_error("Truncated varint");
+            const uint8_t byte = *cursor++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) return value;
+        }
+        throw std::runtime_error("Malformed varint");
+    }
+
+    inline void appendBytes(ByteBuffer& out, const void* data, size_t size) {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        out.insert(out.end(), bytes, bytes + size);
+    }
+
+    inline void readBytes(const uint8_t*& cursor, const uint8_t* end, void* data, size_t size) {
+        if (static_cast<size_t>(end - cursor) < size) throw std::runtime_error("Truncated payload");
+        std::memcpy(data, cursor, size);
+        cursor += size;
+    }
+} // namespace ByteIO
+
+// ValueCodec<T> encodes one element. Specialize it for element types that are
+// neither trivially copyable nor std::string.
+template <typename T, class Enable = void>
+struct ValueCodec;
+
+// Trivially copyable types are stored as their raw object representation.
+template <typename T>
+struct ValueCodec<T, typename std::enable_if<std::is_trivially_copyable<T>::value>::type> {
+    static void encode(ByteBuffer& out, const T& value) {
+        ByteIO::appendBytes(out, &value, sizeof(T));
+    }
+    static T decode(const uint8_t*& cursor, const uint8_t* end) {
+        T value;
+        ByteIO::readBytes(cursor, end, &value, sizeof(T));
+        return value;
+    }
+};
+
+// Strings are stored as varint length + bytes.
+template <>
+struct ValueCodec<std::string> {
+    static void encode(ByteBuffer& out, const std::string& value) {
+        ByteIO::appendVarint(out, value.size());
+        ByteIO::appendBytes(out, value.data(), value.size());
+    }
+    static std::string decode(const uint8_t*& cursor, const uint8_t* end) {
+        const uint64_t length = ByteIO::readVarint(cursor, end);
+        if (static_cast<uint64_t>(end - cursor) < length) throw std::runtime_error("Truncated string");
+        std::string value(reinterpret_cast<const char*>(cursor), static_cast<size_t>(length));
+        cursor += length;
+        return value;
+    }
+};
+
+#endif // VALUE_CODEC_H
@@ -0,0 +1,70 @@
+#ifndef VIEW_OBSERVERS_H
+#define VIEW_OBSERVERS_H
+
+#include <cstdint>    // Required for uint64_t
+#include <functional> // Required for std::function
+#include <list>       // Required for std::list
+#include <mutex>      // Required for std::mutex, std::lock_guard
+#include <utility>    // Required for std::pair
+#include <vector>     // Required for std::vector
+#include "ChangeEvent.h"
+
+// Observer registry for derived views (TopKView, SortedView, ...). Views are
+// observables in their own right: they publish ChangeEvent<T> describing
+// changes to the view, with the same addObserver()/removeObserver() API as
+// ObservableContainer. Events are dispatched after the view's own lock is
+// released, so observers may query the view.
+template <typename T>
+class ViewObservers {
+public:
+    using ObserverCallback = std::function<void(const ChangeEvent<T>&)>;
+    using ObserverHandle = uint64_t;
+
+    ObserverHandle addObserver(const ObserverCallback& observer) {
+        std::lock_guard<std::mutex> lock(observers_mutex_);
+        const ObserverHandle handle = ++next_handle_;
+        observers_.emplace_back(handle, observer);
+        return handle;
+    }
+
+    bool removeObserver(ObserverHandle handle) {
+        std::lock_guard<std::mutex> lock(observers_mutex_);
+        const auto original_size = observers_.size();
+        observers_.remove_if([handle](const auto& entry) { return entry.first == handle; });
+        return observers_.size() < original_size;
+    }
+
+protected:
+    ViewObservers() = default;
+    ~ViewObservers() = default;
+    ViewObservers(const ViewObservers&) = delete;
+    ViewObservers& operator=(const ViewObservers&) = delete;
+
+    void dispatch(const std::vector<ChangeEvent<T>>& events) const {
+        if (events.empty()) {
+            return;
+        }
+        std::vector<ObserverCallback> callbacks;
+        {
+            std::lock_guard<std::mutex> lock(observers_mutex_);
+            callbacks.reserve(observers_.size());
+            for (const auto& entry : observers_) {
+                callbacks.push_back(entry.second);
+            }
+        }
+        for (const ChangeEvent<T>& event : events) {
+            for (const auto& callback : callbacks) {
+                if (callback) {
+                    callback(event);
+                }
+            }
+        }
+    }
+
+private:
+    mutable std::mutex observers_mutex_;
+    std::list<std::pair<ObserverHandle, ObserverCallback>> observers_;
+    ObserverHandle next_handle_ = 0;
+};
+
+#endif // VIEW_OBSERVERS_H
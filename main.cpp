@@ -13,6 +13,7 @@ std::string ChangeTypeToString(ChangeType type) {
         case ChangeType::ElementModified:return "ElementModified";
         case ChangeType::SizeChanged:    return "SizeChanged";
         case ChangeType::BatchUpdate:    return "BatchUpdate"; // Added
+        case ChangeType::Permuted:       return "Permuted";
         default:                         return "UnknownChange";
     }
 }